@@ -85,10 +85,38 @@ Y_gy_setlocale(int argc)
 
 }
 
+/* GObjects whose id was handed out by gy_id, so that gy_map can turn
+   ids back into objects. An object leaves the table when it is
+   destroyed: ids do not hold references. */
+static GHashTable * gy_ids = NULL;
+
+static void
+gy_id_forget(gpointer data, GObject * object)
+{
+  g_hash_table_remove(gy_ids, object);
+}
+
+GObject *
+gy_id_lookup(long id)
+{
+  return gy_ids ? g_hash_table_lookup(gy_ids, (gpointer) id) : NULL;
+}
+
 void
 Y_gy_id(int argc)
 {
-  ypush_long((long) yget_gy_Object(argc-1)->object);
+  gy_Object * o = yget_gy_Object(argc-1);
+  if (o->object && (o->lazy || (gy_Object_resolve(o) &&
+				(GI_IS_OBJECT_INFO(o->info) ||
+				 GI_IS_INTERFACE_INFO(o->info)))) &&
+      G_IS_OBJECT(o->object)) {
+    if (!gy_ids) gy_ids = g_hash_table_new(NULL, NULL);
+    if (!g_hash_table_contains(gy_ids, o->object)) {
+      g_hash_table_insert(gy_ids, o->object, o->object);
+      g_object_weak_ref(o->object, &gy_id_forget, NULL);
+    }
+  }
+  ypush_long((long) o->object);
 }
 
 /*
@@ -18,6 +18,7 @@
  */
 
 #include <girepository.h>
+#include <girffi.h>
 #include <glib-object.h>
 
 #include "yapi.h"
@@ -27,6 +28,7 @@
 #include <fenv.h>
 #include <string.h>
 #include <signal.h>
+#include <setjmp.h>
 #include <locale.h>
 //#include <pthread.h>
 //#include <stdio.h>
@@ -34,8 +36,17 @@
 typedef struct _gy_signal_data {
   GIBaseInfo * info;
   GIRepository * repo;
-  const char * cmd;
+  struct _gy_Signal * signal;
+  const char * cmd;  // handler name, NULL if anonymous
+  long idx;          // global variable holding the handler, -1 if
+                     // anonymous or an expression
+  void * func;       // use of an anonymous handler
+  void * udata;      // use of the user data wrapper, made on first call
   void * data;
+  gint delay;        // -1: immediate, 0: coalesce, else debounce (ms)
+  guint source;      // pending delivery
+  guint n_pending;
+  GValue * pending;  // parameters of the latest deferred emission
 } gy_signal_data;
 
 gboolean gy_debug() ;
@@ -47,14 +58,23 @@ typedef struct _gy_Object {
   GIBaseInfo * info;
   GObject * object;
   GIRepository * repo;
+  gboolean lazy; // object is a GObject, info resolved on first use
+  gboolean bound; // method closure holding a reference on object
+  struct _gy_Plan * plan; // set by gy_bind
+  GType boxed; // object is a boxed value of this type, owned by us
+  gboolean owned; // object is a plain structure we g_malloc'ed
+  // G(S)List wrappers: length, and last element accessed by index
+  gboolean list_sized;
+  glong list_size;
+  GSList * cursor;
+  glong cursor_idx;
 } gy_Object;
 gy_Object* yget_gy_Object(int);
 gy_Object* ypush_gy_Object();
+GObject * gy_id_lookup(long id);
 void gy_Argument_pushany(GIArgument * arg, GITypeInfo * info, gy_Object* o);
 
 
-void gy_sa_handler(int sig) ;
-
 typedef struct _gy_Typelib {
   GITypelib * typelib;
   gchar * namespace;
@@ -97,23 +117,162 @@ void gy_Object_list(int argc);
 
 void gy_Argument_getany(GIArgument * arg, GITypeInfo * info, int iarg) ;
 void gy_Argument_pushany(GIArgument * arg, GITypeInfo * info, gy_Object* o) ;
+gsize gy_type_tag_size(GITypeTag tag);
+long gy_Argument_array_length(GIArgument * arg, GITypeInfo * info);
+void gy_Argument_pusharray(GIArgument * arg, GITypeInfo * info, long len,
+			   GITransfer transfer);
+void gy_Argument_array_own(GIArgument * arg, GITypeInfo * info, long ntot,
+			   GITransfer transfer);
+long gy_Argument_get_long(GIArgument * arg, GITypeInfo * info);
+void gy_Argument_set_long(GIArgument * arg, GITypeInfo * info, long value);
 int yarg_gy_Object(int iarg) ;
 gy_Object* yget_gy_Object(int iarg);
 gy_Object* ypush_gy_Object() ;
+GIBaseInfo * gy_Object_resolve(gy_Object * o);
+
+/// Class cache
+
+typedef struct _gy_Class {
+  GIBaseInfo * info;
+  GType gtype;
+  GHashTable * methods;
+  GHashTable * properties;
+  GHashTable * fields;
+  GHashTable * value_names; // enums and flags
+  gint64 * values;
+  GHashTable * signals;
+} gy_Class;
+
+gy_Class * gy_Class_get(GIBaseInfo * info);
+GIBaseInfo * gy_info_from_gtype(GType gtype);
+GIBaseInfo * gy_glib_info(GType gtype);
+GIFunctionInfo * gy_Class_find_method(gy_Class * klass, const char * name);
+gboolean gy_Class_find_value(gy_Class * klass, const char * name,
+			     gint64 * value);
+
+/// Signals
+typedef struct _gy_Signal {
+  GISignalInfo * info;
+  const gchar * name;    // as requested, possibly with "::detail"
+  guint id;              // 0 if the signal could not be parsed
+  GQuark detail;
+  gint nargs;
+  GITypeTag rettag;
+  GIBaseInfo ** arginfos; // structure and union arguments: declared type
+  const struct _gy_ValueConv ** convs; // instance and arguments
+  const struct _gy_ValueConv * retconv;
+} gy_Signal;
+
+gy_Signal * gy_Class_find_signal(gy_Class * klass, const char * name);
+
+/// GBytes
+gboolean gy_type_is_bytes(GITypeInfo * info);
+void gy_bytes_push(GBytes * bytes);
+GBytes * gy_bytes_get(int iarg);
+
+/// GVariant
+gboolean gy_type_is_variant(GITypeInfo * info);
+void gy_variant_push(GVariant * v);
+GVariant * gy_variant_get(int iarg, const gchar * type);
+
+/// Scratch arena
+#define GY_SMALL_ARITY 8
+gpointer gy_arena_alloc(gsize size);
+void gy_arena_defer(GDestroyNotify func, gpointer data);
+void gy_arena_push_scope(void);
 
-void gy_callback0(void* arg1, gy_signal_data* sd) ;
-gboolean gy_callback0_bool(void* arg1, gy_signal_data* sd) ;
-void gy_callback1(void* arg1, void* arg2, gy_signal_data* sd) ;
-gboolean gy_callback1_bool(void* arg1, void* arg2, gy_signal_data* sd) ;
-void gy_callback2(void* arg1, void* arg2, void* arg3, gy_signal_data* sd) ;
-gboolean gy_callback2_bool(void* arg1, void* arg2, void*arg3,
-			   gy_signal_data* sd) ;
+/// Call plans
+typedef void (*gy_Marshaler)(GIArgument * arg, GITypeInfo * info, int iarg);
+
+typedef struct _gy_Slot {
+  GITypeInfo * type;
+  GIDirection direction;
+  GITransfer transfer;
+  gy_Marshaler marshal;
+  gboolean caller_allocates;
+  gsize size;         // of caller-allocated structures
+  GType gtype;        // of caller-allocated structures, or G_TYPE_NONE
+  gint length;        // arrays: index of the length argument, or -1
+  gboolean is_length; // length of an array argument or of the return value
+} gy_Slot;
+
+typedef struct _gy_Plan {
+  GIFunctionInfo * info;
+  gboolean is_method;
+  gboolean throws;
+  gint n_args;        // arguments expected from Yorick
+  gy_Slot * slots;
+  gint n_in, n_out;   // n_in includes the instance
+  gint n_out_only;    // out (not inout) arguments
+  gint n_length;      // length arguments, may be omitted
+  gint n_out_plain;   // out arguments which are not lengths
+  GITypeInfo * rettype;
+  GITypeTag rettag;   // enums and flags: storage type
+  GITransfer rettransfer;
+  gint retlength;     // array return value: index of the length, or -1
+  gboolean uses_fp;   // takes or returns floating point values
+  gboolean prepped;   // else fall back to g_function_info_invoke
+  GIFunctionInvoker invoker;
+} gy_Plan;
+
+gy_Plan * gy_Plan_get(GIFunctionInfo * info);
+gboolean gy_Plan_invoke(gy_Plan * plan,
+			GIArgument * in_args, GIArgument * out_args,
+			GIArgument * retval, GError ** err);
+
+/// GValue converters
+typedef struct _gy_ValueConv gy_ValueConv;
+typedef void (*gy_ValueSetter)(const gy_ValueConv * conv, GValue * val,
+			       int iarg);
+typedef void (*gy_ValuePusher)(const gy_ValueConv * conv, GValue * val,
+			       gy_Object * o);
+struct _gy_ValueConv {
+  GType gtype;
+  gy_ValueSetter set;
+  gy_ValuePusher push;
+  gint n_cells;         // flat boxed structures: number of fields,
+  GITypeTag cell_tag;   // their type
+  gsize struct_size;    // and the size of the structure
+};
+
+const gy_ValueConv * gy_value_conv_for(GType gtype);
 
 /// Properties
-GIPropertyInfo * gy_base_info_find_property_info(GIBaseInfo * objectinfo,
-						char * name);
-GIPropertyInfo * gy_base_info_find_field_info(GIBaseInfo * objectinfo,
-						char * name);
+typedef struct _gy_Property {
+  GIPropertyInfo * info;
+  GITypeInfo * type;
+  const gchar * name;      // canonical (hyphenated) name
+  GParamSpec * pspec;
+  GType value_type;
+  GParamFlags flags;
+  const gy_ValueConv * conv; // NULL: convert according to type
+} gy_Property;
+
+gy_Property * gy_Class_find_property(gy_Class * klass, const char * name);
+void gy_Property_value_init(gy_Property * prop, GValue * val);
+void gy_Property_value_set(gy_Property * prop, GValue * val, int iarg);
+void gy_Property_value_push(gy_Property * prop, GValue * val, gy_Object * o);
+
+typedef struct _gy_PropBatch gy_PropBatch;
+gy_PropBatch * gy_PropBatch_push(GObject * object, guint max);
+void gy_PropBatch_set(gy_PropBatch * batch, gy_Property * prop, int iarg);
+void gy_PropBatch_get(gy_PropBatch * batch, gy_Property * prop, long idx);
+void gy_PropBatch_apply(gy_PropBatch * batch, gy_Object * o);
+
+/// Fields
+typedef struct _gy_Field {
+  GIFieldInfo * info;
+  GITypeInfo * type;
+  const gchar * name;
+  GIFieldInfoFlags flags;
+  gint offset;
+  gint size;      // size of directly loadable values, else 0
+  GITypeTag tag;  // type of directly loadable values, else VOID
+} gy_Field;
+
+gy_Field * gy_Class_find_field(gy_Class * klass, const char * name);
+void gy_Field_push(gy_Field * field, gpointer mem, gy_Object * o);
+
 void gy_value_init(GValue* val, GITypeInfo *info);
 void gy_value_set_iarg(GValue* val, GITypeInfo * info, int iarg);
 void gy_value_push(GValue * pval, GITypeInfo * info, gy_Object *o);
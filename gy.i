@@ -76,6 +76,10 @@ local gy_i;
     The last form is convenient and performant when retrieving several
     properties at a time:
       button, xalign, x, yalign, y;
+    All the properties set in one such call are applied together, and
+    "notify" is emitted only once they are all in place, before the
+    properties to retrieve are read:
+      label, label="x", xalign=0.5, sensitive=1, width_request, w;
     Hyphens in properties or filed names in the C documentation are
     replaced with underscores in the Yorick implementation.
 
@@ -89,6 +93,20 @@ local gy_i;
       closure = object.method; closure, arguments;
       noop, object.method(arguments);
 
+    Output arguments are received in variables, passed at their
+    position in the C argument list (nil discards the value); in-out
+    arguments are read from and written back to their variable:
+      noop, window.get_origin(x, y);
+    Output arguments may also be omitted altogether, in which case the
+    call returns the return value (if any) followed by the output
+    values, in a single numeric array, or in an oxy object with
+    anonymous members if some of them are not numbers:
+      xy = window.get_origin()(2:);
+    Arrays are passed and returned as Yorick arrays. Arguments giving
+    the length of an array may be omitted, they are then computed
+    from the array:
+      noop, gy.Gtk.IconTheme.get_default().set_search_path(["/a", "/b"]);
+
     Enum values are accessed likewise:
       var = gy.Gtk.MessageType.error;
     Beware that C documentation may list enum values are CPP
@@ -136,3 +154,73 @@ extern gy;
     
  */
 gy=gy_init();
+
+func gy_variant_get(v)
+/* DOCUMENT value = gy_variant_get(variant)
+
+    Convert a GLib.Variant object into Yorick values, recursively:
+    basic values and arrays of them (e.g. "ad", "as") give Yorick
+    scalars and arrays, dictionaries give oxy objects with one member
+    per key, tuples and other arrays give oxy objects with anonymous
+    members, maybe values give nil or their content.
+
+    Functions returning basic GVariants already return Yorick values,
+    which are returned unchanged.
+
+   EXAMPLE:
+    settings = gy.Gio.Settings.new("org.gnome.desktop.interface");
+    font = gy_variant_get(settings.get_value("font-name"));
+
+   SEE ALSO: gy_variant, gy_variant_put, gy_variant_value
+ */
+{
+  if (typeof(v) != "gy_Object") return v;
+  v = gy_variant_value(v);
+  if (typeof(v) != "gy_Object") return v;
+
+  t = v.get_type_string();
+  c = strpart(t, 1:1);
+  if (c == "v") return gy_variant_get(v.get_variant());
+  n = v.n_children();
+  if (c == "m") return n ? gy_variant_get(v.get_child_value(0)) : [];
+
+  res = save();
+  if (strpart(t, 1:2) == "a{") {
+    for (i=0; i<n; ++i) {
+      e = v.get_child_value(i);
+      key = gy_variant_get(e.get_child_value(0));
+      if (structof(key) != string) key = totxt(key);
+      save, res, key, gy_variant_get(e.get_child_value(1));
+    }
+  } else {
+    for (i=0; i<n; ++i)
+      save, res, string(0), gy_variant_get(v.get_child_value(i));
+  }
+  return res;
+}
+
+func gy_variant_put(obj)
+/* DOCUMENT variant = gy_variant_put(obj)
+
+    Convert Yorick value OBJ into a GLib.Variant object. Oxy objects
+    whose members all have names give dictionaries of type "a{sv}",
+    other oxy objects give tuples; their members are converted
+    recursively. Other values are converted by gy_variant.
+
+   SEE ALSO: gy_variant, gy_variant_get
+ */
+{
+  if (typeof(obj) != "oxy_object") return gy_variant(obj);
+  GLib = gy.GLib;
+  n = obj(*);
+  keys = obj(*,);
+  dict = n && noneof(keys == string(0));
+  b = GLib.VariantBuilder.new(GLib.VariantType.new(dict ? "a{sv}" : "r"));
+  for (i=1; i<=n; ++i) {
+    v = gy_variant_put(obj(noop(i)));
+    if (dict) v = GLib.Variant.new_dict_entry(gy_variant(keys(i)),
+                                              gy_variant(v, "v"));
+    noop, b.add_value(v);
+  }
+  return b.end();
+}
@@ -37,13 +37,19 @@ extern gy_list;
  */
 
 extern gy_signal_connect;
-/* DOCUMENT gy_connect_signal, object, signal, handler
+/* DOCUMENT gy_connect_signal, object, signal, handler [, data]
          or gy_connect_signal, builder
    
     Connect signal to signal handler.
     
     The handler must accept all the parameters described in the C
-    documentation for the signal.
+    documentation for the signal, plus the user data. Parameters are
+    converted according to their type: numbers, strings and enums
+    arrive as Yorick values, objects and structures as gy objects of
+    the type declared by the signal (e.g. a Gdk.EventButton for
+    "button-press-event"), so that no cast is needed. Signals may have
+    any number of parameters; the value returned by the handler, if
+    not nil, is converted to the return type of the signal.
 
    ARGUMENTS:
     builder: if first argument is a Gtk Builder object, the signals
@@ -54,19 +60,57 @@ extern gy_signal_connect;
     object:  a gy object supporting signals, e.g. an instance of
              gy.Gtk.Entry.
     signal:  the signal name, e.g. "activated".
-    handler: the Yorick command to be executed when the object
-             receives the signal. HANDLER will be called like:
-             include, ["noop, " + handler + "(par1, ..., parn)"], 1
+    handler: the Yorick function to be called when the object
+             receives the signal, like:
+             handler(par1, ..., parn)
              where par1 to parn are the parameters described in the C
-             documentation for SIGNAL. HANDLER may be a string or a
-             Yorick function.
+             documentation for SIGNAL. HANDLER may be a function or
+             the name of one. A named handler (or a function passed
+             through a variable of that name) is looked up at each
+             signal, so it may be redefined later; the call does not
+             go through the parser. Any other string is an expression
+             evaluating to a function, e.g. "obj.method"; it is parsed
+             at each signal, the parameters being passed through the
+             global variables __gy_callback_var1...
              
+   KEYWORDS:
+    coalesce=1: do not call HANDLER for each emission, but once per
+             main loop iteration, with the parameters of the latest
+             emission. Useful for high frequency signals such as
+             "motion-notify-event".
+    debounce=DELAY: call HANDLER only when SIGNAL has not been emitted
+             for DELAY seconds, with the parameters of the latest
+             emission, e.g. for the "value-changed" signal of a slider
+             triggering a long computation.
+             With either keyword, HANDLER runs after the emission: its
+             return value is ignored, the signal returns its default
+             value (for events: not handled), and parameters which are
+             raw pointers are NULL.
+
    EXAMPLE:
     See gy.
+    gy_signal_connect, scale, "value-changed", recompute, debounce=0.2;
 
    SEE ALSO: gy
 */
 
+extern gy_flags;
+/* DOCUMENT mask = gy_flags(type, name1, name2, ...)
+
+    Combine enum or flags values into a single mask. TYPE is a gy
+    enum or flags type, e.g. gy.Gdk.ModifierType. Each NAME may be a
+    string, an array of strings or a number; a string may hold several
+    value names separated by "|", "," or blanks. Names are
+    case-insensitive.
+
+   EXAMPLE:
+    mask = gy_flags(Gdk.ModifierType, "shift_mask|mod1_mask");
+    // same as:
+    mask = Gdk.ModifierType.shift_mask | Gdk.ModifierType.mod1_mask;
+
+   SEE ALSO: gy
+ */
+
 extern gy_debug;
 /* DOCUMENT mode = gy_debug();
          or gy_debug, mode;
@@ -74,6 +118,120 @@ extern gy_debug;
    SEE ALSO: gy
 */
 
+extern gy_guard;
+/* DOCUMENT mode = gy_guard();
+         or gy_guard, mode;
+    Get or set the protection level of calls to introspected functions:
+      0: no protection;
+      1: (default) a crash (SIGSEGV or SIGABRT) in the called function
+         is turned into a Yorick error; floating point exceptions are
+         held during every call;
+      2: same, and the signal mask is restored after a crash;
+     -1: same as 1, but floating point exceptions are held only around
+         functions which take or return floating point values.
+    Mode -1 is an opt-in for code which calls many functions known not
+    to compute with floating point values: others (e.g. Gtk functions
+    running layout or signal handlers) may then raise SIGFPE.
+   SEE ALSO: gy, gy_debug
+*/
+
+extern gy_bytes;
+/* DOCUMENT bytes = gy_bytes(array)
+
+    Wrap the memory of numeric ARRAY in a GLib.Bytes object, for
+    functions which take GBytes, without copying it:
+      stream = gy.Gio.MemoryInputStream.new_from_bytes(gy_bytes(data));
+    ARRAY must not be modified as long as BYTES (or a copy held by
+    GLib) is alive: GLib treats the content of BYTES as immutable,
+    but modifying ARRAY in place changes it behind its back.
+
+    BYTES holds a reference to ARRAY until GLib releases it. When this
+    happens in a worker thread (asynchronous GIO operations), ARRAY is
+    only freed on the next iteration of the main loop (see
+    gy_gtk_idler) or the next call to gy_bytes.
+
+    Functions returning GBytes return a char array holding a copy of
+    the data.
+
+   SEE ALSO: gy
+*/
+
+extern gy_pixbuf;
+/* DOCUMENT pixbuf = gy_pixbuf(image)
+         or image = gy_pixbuf(pixbuf)
+
+    Convert between a Yorick image and a GdkPixbuf.Pixbuf. IMAGE is a
+    char(3, width, height) (RGB), char(4, width, height) (RGBA) or
+    char(width, height) (grey levels) array. RGB and RGBA images are
+    not copied: PIXBUF uses the memory of IMAGE, which must not be
+    modified while PIXBUF is in use. The result can be displayed
+    directly:
+      noop, gtkimage.set_from_pixbuf(gy_pixbuf(bytscl(z)));
+
+    Conversely, the pixels of PIXBUF (8 bits per sample) are returned
+    as a char(n_channels, width, height) array, without row padding.
+
+   SEE ALSO: gy, gy_bytes
+*/
+
+extern gy_cairo_surface;
+extern gy_cairo_paint;
+/* DOCUMENT surface = gy_cairo_surface(image [, format])
+         or gy_cairo_paint, cr, surface [, x, y, scale]
+
+    gy_cairo_surface returns a cairo image surface (a cairo.Surface
+    object) holding IMAGE, which may be:
+      int(width, height): native-endian ARGB32 pixels, or RGB24 if
+                          FORMAT is "RGB24";
+      char(width, height): alpha mask (A8);
+      char(3, width, height): RGB, char(4, width, height): RGBA.
+    Int images, and char(width, height) ones when WIDTH is a multiple
+    of 4, are not copied: the surface uses the memory of IMAGE, so
+    later changes to IMAGE show at the next paint. Other images are
+    converted once.
+
+    gy_cairo_paint paints SURFACE on cairo context CR with its upper
+    left corner at (X, Y) (default: 0, 0), optionally scaled by SCALE.
+    CR is typically the second argument of a "draw" handler:
+      func on_draw(widget, cr, data) {
+        gy_cairo_paint, cr, frame_surface;
+        return 1;
+      }
+      gy_signal_connect, area, "draw", on_draw;
+    Call area.queue_draw() after modifying the image.
+
+   SEE ALSO: gy, gy_pixbuf, gy_signal_connect
+*/
+
+extern gy_variant;
+extern gy_variant_value;
+/* DOCUMENT variant = gy_variant(value [, type])
+         or value = gy_variant_value(variant)
+
+    gy_variant converts VALUE into a GLib.Variant object of GVariant
+    type TYPE (a string such as "i", "ad" or "a{sv}"). Without TYPE,
+    the type follows VALUE: char, short, int and long give "y", "n",
+    "i" and "x", float and double give "d", strings give "s", arrays
+    of them give the corresponding array type ("ay", "as"...).
+
+    Numeric arrays are not copied: the GVariant uses the memory of
+    VALUE, which must not be modified afterwards. With TYPE "v", VALUE
+    is boxed in a variant. A scalar string with any other TYPE is
+    parsed using the GVariant text format:
+      gy_variant("{'width': <640>, 'title': <'plot'>}", "a{sv}")
+
+    Where a function expects a GVariant, Yorick values are converted
+    likewise; pass gy_variant(value, type) to choose the type.
+    Returned GVariants of basic types and arrays of them come back as
+    Yorick values; the others (tuples, dictionaries...) as GLib.Variant
+    objects, which gy_variant_get converts to oxy objects.
+
+    gy_variant_value converts VARIANT into a Yorick value in the same
+    way, one level only.
+
+   SEE ALSO: gy, gy_variant_get, gy_variant_put
+*/
+
 extern gy_setlocale;
 /* DOCUMENT gy_setlocale, [category,] locale
          or locale=gy_setlocale()
@@ -86,12 +244,123 @@ extern gy_setlocale;
    SEE ALSO: gy
  */
 
+extern gy_bind;
+/* DOCUMENT handle = gy_bind(object, "method")
+
+    Bind METHOD to OBJECT once and for all. HANDLE can then be called
+    like OBJECT.METHOD, but the method lookup and the preparation of
+    the call are done only once, which matters in tight loops. HANDLE
+    keeps a reference on OBJECT.
+
+   EXAMPLE:
+    set_text = gy_bind(label, "set_text");
+    for (i=1; i<=n; ++i) set_text, swrite(format="%d", i);
+
+   SEE ALSO: gy
+*/
+
+extern gy_map;
+/* DOCUMENT result = gy_map(objects, "member", arg1, arg2, ...)
+
+    Call method MEMBER, or get or set property MEMBER, on each of
+    OBJECTS, looping in compiled code. OBJECTS may be a G(S)List as
+    returned by a function, a single object or an array of ids as
+    returned by gy_id (an id is rejected once its object has been
+    destroyed). Only GObjects are supported.
+
+    Each ARG may be a scalar, passed to every call, or an array with
+    one element per object. A property is read when no ARG is given,
+    set when one is.
+
+    RESULT is an array with one element per object, of the type of the
+    first result: long, double or string. Objects are returned in an
+    oxy object, RESULT(i) being the result for the i-th object: the gy
+    objects it holds keep their references, which are released when
+    RESULT is. RESULT is nil if MEMBER returns nothing.
+
+   EXAMPLES:
+    // any toplevel visible?
+    anyof(gy_map(Gtk.Window.list_toplevels(), "visible"))
+    // update many labels
+    gy_map, labels, "set_text", swrite(format="%g", values);
+
+   SEE ALSO: gy, gy_bind, gy_id
+*/
+
+extern gy_list_to_array;
+/* DOCUMENT array = gy_list_to_array(list)
+
+    Convert a G(S)List, as returned by a function, into a Yorick array
+    in one pass: strings for lists of strings, long for lists of
+    integers. Returns nil for an empty list. Lists of objects are not
+    converted, since nothing would keep the objects alive: pass the
+    list itself to gy_map.
+
+    Lists can also be walked from Yorick: LIST.size (computed once),
+    LIST(i) (sequential access is cheap), LIST.data, LIST.next and,
+    for GLists, LIST.prev.
+
+   EXAMPLE:
+    titles = gy_map(Gtk.Window.list_toplevels(), "get_title");
+
+   SEE ALSO: gy, gy_map, gy_id
+*/
+
+extern gy_gtk_readout;
+extern gy_gtk_readout_limits;
+extern gy_gtk_readout_coords;
+extern gy_gtk_readout_zoom;
+extern gy_gtk_readout_show;
+/* DOCUMENT gy_gtk_readout, da, slabel, xlabel, ylabel, dpi
+         or gy_gtk_readout_limits, da, viewport(), limits(), hadj, vadj
+         or gy_gtk_readout_limits, da
+         or xy = gy_gtk_readout_coords(da, x, y)
+         or lm = gy_gtk_readout_zoom(da, x0, y0, x1, y1, button)
+         or gy_gtk_readout_show, da, x, y, sys
+
+    Compiled mouse readout for a Yorick window embedded in Gtk.DrawingArea
+    DA, used by gy_gtk_ywindow.
+
+    gy_gtk_readout attaches the readout to DA (or updates it): the
+    Gtk.Label widgets SLABEL, XLABEL and YLABEL (each may be nil)
+    show the coordinate system and the mouse position, and DPI is the
+    resolution of the Yorick window. A handler is connected to the
+    "event" signal of DA, so call gy_gtk_readout before connecting
+    other handlers to "event".
+
+    gy_gtk_readout_limits caches the viewport and limits of the Yorick
+    window, and the Gtk.Adjustment objects which scroll DA. From then
+    on, the readout handles motion events itself: the pointer position
+    is converted to world coordinates in compiled code and the labels
+    are updated when their text changes; such events do not reach the
+    other handlers. Motion outside the visible part of DA is left to
+    them. Call gy_gtk_readout_limits again whenever the limits may
+    have changed; with DA alone, it stops handling motion.
+
+    gy_gtk_readout_coords returns the world coordinates [xs, ys] of
+    pixel (X, Y) of DA, clamped to the limits.
+
+    gy_gtk_readout_zoom returns [xmin, xmax, ymin, ymax, setx, sety]:
+    the limits after dragging with BUTTON from world coordinates (X0,
+    Y0) to (X1, Y1), like the zoom of mouse(), and whether each axis
+    changed.
+
+    gy_gtk_readout_show sets the labels for position (X, Y) in
+    coordinate system SYS (number or string), changing only labels
+    whose text differs.
+
+   SEE ALSO: gy_gtk_ywindow, gy_gtk_ywindow_connect
+*/
+
 extern gy_id;
 /* DOCUMENT id = gy_id(object)
     
       Get unique id of gy object. Two variables may hold the same
       underlying object: the id is unique.
 
+      The id does not hold a reference on the object. Ids of GObjects
+      can be passed to gy_map as long as the object is alive.
+
    SEE ALSO: gy
 */
 
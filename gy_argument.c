@@ -95,14 +95,9 @@ void gy_Argument_getany(GIArgument * arg, GITypeInfo * info, int iarg) {
 	case GI_TYPE_TAG_INT8:
 	  arg->v_pointer=ygeta_gint8(iarg, &ntot, 0);
 	  break;
-	case GI_TYPE_TAG_UINT8:{
-	  guint8* tmp=ygeta_guint8(iarg, &ntot, 0);
-	  GY_DEBUG("Array size: %ld\n", ntot);
-	  GY_DEBUG("First value in array: %d\n", tmp[0]);
-	  GY_DEBUG("Last value in array: %d\n", tmp[ntot-1]);
-	  arg->v_pointer=malloc(ntot*sizeof(guint8));
-	  memcpy(arg->v_pointer, tmp, ntot*sizeof(guint8));
-	  break;}
+	case GI_TYPE_TAG_UINT8:
+	  arg->v_pointer=ygeta_guint8(iarg, &ntot, 0);
+	  break;
 
 	case GI_TYPE_TAG_INT16:
 	  arg->v_pointer=ygeta_gint16(iarg, &ntot, 0);
@@ -144,6 +139,14 @@ void gy_Argument_getany(GIArgument * arg, GITypeInfo * info, int iarg) {
 	default:
 	  y_error("Unimplemented GIArgument array type");
 	}
+	if (arg->v_pointer && g_type_info_is_zero_terminated(info)) {
+	  // Yorick arrays are not terminated: copy and append a zero
+	  gsize sz = gy_type_tag_size(ctag);
+	  guint8 * buf = gy_arena_alloc((ntot+1)*sz);
+	  memcpy(buf, arg->v_pointer, ntot*sz);
+	  memset(buf+ntot*sz, 0, sz);
+	  arg->v_pointer = buf;
+	}
 	GY_DEBUG("Got array pointer: %p\n", arg->v_pointer);
 	break;
       default:
@@ -168,14 +171,28 @@ void gy_Argument_getany(GIArgument * arg, GITypeInfo * info, int iarg) {
 	  break;
 	}
 	if (g_type_is_a (g_type, G_TYPE_VALUE)) {
-	  GValue val=G_VALUE_INIT;
+	  GValue * val = gy_arena_alloc(sizeof(GValue));
 	  // should check type passed from yorick!
 	  GObject * obj = yget_gy_Object(iarg)->object;
-	  g_value_init (&val, G_TYPE_OBJECT );
-	  g_value_set_object(&val, obj);
-	  arg->v_pointer = &val;
+	  memset(val, 0, sizeof(GValue));
+	  g_value_init (val, G_TYPE_OBJECT );
+	  g_value_set_object(val, obj);
+	  gy_arena_defer((GDestroyNotify) g_value_unset, val);
+	  arg->v_pointer = val;
+	  break;
+	}
+	if (g_type == G_TYPE_VARIANT) {
+	  GVariant * v = gy_variant_get(iarg, NULL);
+	  // values built for the call are floating: the call owns them
+	  if (g_variant_is_floating(v)) {
+	    g_variant_ref_sink(v);
+	    gy_arena_defer((GDestroyNotify) g_variant_unref, v);
+	  }
+	  arg->v_pointer = v;
 	  break;
 	}
+	if (g_type == G_TYPE_BYTES && !yarg_gy_Object(iarg))
+	  y_error("expecting GBytes, use gy_bytes(array)");
       }
       arg->v_pointer=yget_gy_Object(iarg)->object;
       break;
@@ -321,6 +338,16 @@ void gy_Argument_pushany(GIArgument * arg, GITypeInfo * info, gy_Object* o) {
       break;
     case GI_INFO_TYPE_INTERFACE:
     case GI_INFO_TYPE_STRUCT:
+      if (g_registered_type_info_get_g_type(itrf) == G_TYPE_BYTES) {
+	gy_bytes_push(arg->v_pointer);
+	break;
+      }
+      if (g_registered_type_info_get_g_type(itrf) == G_TYPE_VARIANT) {
+	if (arg->v_pointer) gy_variant_push(arg->v_pointer);
+	else ypush_nil();
+	break;
+      }
+      // fall through
     case GI_INFO_TYPE_OBJECT:
       if (!arg -> v_pointer) ypush_nil();
       outObject = ypush_gy_Object();
@@ -332,30 +359,27 @@ void gy_Argument_pushany(GIArgument * arg, GITypeInfo * info, gy_Object* o) {
 	g_object_ref(outObject -> object);
 
 	if (G_IS_OBJECT(outObject -> object)) {
-	  outObject->info =
-	    g_irepository_find_by_gtype(o -> repo,
-					G_OBJECT_TYPE(outObject->object));
-	  if (!outObject->info) {
-	    GY_DEBUG("unable to find object type !");
-	    //outObject -> info = info;
-	    //g_base_info_ref(info);
-	  }
+	  // the actual type is resolved by gy_Object_resolve if needed
+	  outObject -> lazy = TRUE;
 	} else {
 	  outObject -> info = info;
 	  g_base_info_ref(info);
 	}
 	break;
       }
-      outObject -> info =
-	g_irepository_find_by_gtype(o -> repo,
-				    g_registered_type_info_get_g_type(itrf));
-      g_base_info_ref(outObject->info);
+      outObject -> info = g_base_info_ref(itrf);
       break;
     default:
       y_errorn("Unimplemented output GIArgument interface type %ld",
 	       g_base_info_get_type (itrf));
     }
     break;
+  case GI_TYPE_TAG_ARRAY: {
+    long len = gy_Argument_array_length(arg, info);
+    if (len < 0) y_error("array of unknown length");
+    gy_Argument_pusharray(arg, info, len, GI_TRANSFER_NOTHING);
+    break;
+  }
   case GI_TYPE_TAG_GLIST:
   case GI_TYPE_TAG_GSLIST:
     outObject = ypush_gy_Object();
@@ -370,3 +394,243 @@ void gy_Argument_pushany(GIArgument * arg, GITypeInfo * info, gy_Object* o) {
 	     g_type_tag_to_string(type));
   }
 }
+
+/// ARRAYS
+
+/* Size of an array element of type TAG, 0 if not supported. */
+gsize
+gy_type_tag_size(GITypeTag tag)
+{
+  switch (tag) {
+  case GI_TYPE_TAG_INT8:
+  case GI_TYPE_TAG_UINT8:
+    return 1;
+  case GI_TYPE_TAG_INT16:
+  case GI_TYPE_TAG_UINT16:
+    return 2;
+  case GI_TYPE_TAG_BOOLEAN:
+  case GI_TYPE_TAG_INT32:
+  case GI_TYPE_TAG_UINT32:
+  case GI_TYPE_TAG_UNICHAR:
+  case GI_TYPE_TAG_FLOAT:
+    return 4;
+  case GI_TYPE_TAG_INT64:
+  case GI_TYPE_TAG_UINT64:
+  case GI_TYPE_TAG_DOUBLE:
+    return 8;
+  case GI_TYPE_TAG_GTYPE:
+    return sizeof(GType);
+  case GI_TYPE_TAG_UTF8:
+  case GI_TYPE_TAG_FILENAME:
+    return sizeof(gpointer);
+  default:
+    return 0;
+  }
+}
+
+/* Type of the cells of array INFO, enums replaced by their storage
+   type. */
+static GITypeTag
+gy_array_cell_tag(GITypeInfo * info)
+{
+  GITypeInfo * cell = g_type_info_get_param_type(info, 0);
+  GITypeTag tag = g_type_info_get_tag(cell);
+  if (tag == GI_TYPE_TAG_INTERFACE) {
+    GIBaseInfo * itrf = g_type_info_get_interface(cell);
+    if (GI_IS_ENUM_INFO(itrf)) tag = g_enum_info_get_storage_type(itrf);
+    g_base_info_unref(itrf);
+  }
+  g_base_info_unref(cell);
+  return tag;
+}
+
+/* Number of elements of array ARG if it can be known from the array
+   itself (fixed size, zero-terminated, GArray...), else -1. */
+long
+gy_Argument_array_length(GIArgument * arg, GITypeInfo * info)
+{
+  long len;
+  if (!arg->v_pointer) return 0;
+  switch (g_type_info_get_array_type(info)) {
+  case GI_ARRAY_TYPE_ARRAY:
+    return ((GArray*)arg->v_pointer)->len;
+  case GI_ARRAY_TYPE_PTR_ARRAY:
+    return ((GPtrArray*)arg->v_pointer)->len;
+  case GI_ARRAY_TYPE_BYTE_ARRAY:
+    return ((GByteArray*)arg->v_pointer)->len;
+  default:
+    break;
+  }
+  if ((len = g_type_info_get_array_fixed_size(info)) >= 0) return len;
+  if (!g_type_info_is_zero_terminated(info)) return -1;
+
+  gsize sz = gy_type_tag_size(gy_array_cell_tag(info)), i;
+  guint8 * p = arg->v_pointer;
+  if (!sz) return -1;
+  for (len=0; ; ++len, p+=sz) {
+    for (i=0; i<sz && !p[i]; ++i) ;
+    if (i==sz) return len;
+  }
+}
+
+/* Push the LEN elements of array ARG as a Yorick array. Memory is
+   released according to TRANSFER. */
+void
+gy_Argument_pusharray(GIArgument * arg, GITypeInfo * info, long len,
+		      GITransfer transfer)
+{
+  GIArrayType atype = g_type_info_get_array_type(info);
+  GITypeTag ctag = gy_array_cell_tag(info);
+  gsize sz = gy_type_tag_size(ctag);
+  gpointer data = arg->v_pointer;
+  long dims[Y_DIMSIZE] = {1, len}, i;
+
+  if (!sz)
+    y_errorq("Unimplemented array element type: %s",
+	     g_type_tag_to_string(ctag));
+
+  if (data) {
+    switch (atype) {
+    case GI_ARRAY_TYPE_ARRAY:
+      data = ((GArray*)arg->v_pointer)->data;
+      break;
+    case GI_ARRAY_TYPE_PTR_ARRAY:
+      data = ((GPtrArray*)arg->v_pointer)->pdata;
+      break;
+    case GI_ARRAY_TYPE_BYTE_ARRAY:
+      data = ((GByteArray*)arg->v_pointer)->data;
+      break;
+    default:
+      break;
+    }
+  }
+
+  if (!data || len <= 0) ypush_nil();
+  else switch (ctag) {
+    case GI_TYPE_TAG_INT8: {
+      // Yorick char is unsigned
+      short * out = ypush_s(dims);
+      for (i=0; i<len; ++i) out[i] = ((gint8*)data)[i];
+      break;
+    }
+    case GI_TYPE_TAG_UINT8:
+      memcpy(ypush_c(dims), data, len);
+      break;
+    case GI_TYPE_TAG_INT16:
+      memcpy(ypush_s(dims), data, len*sz);
+      break;
+    case GI_TYPE_TAG_UINT16: {
+      // would not fit in short, as for scalars
+      long * out = ypush_l(dims);
+      for (i=0; i<len; ++i) out[i] = ((guint16*)data)[i];
+      break;
+    }
+    case GI_TYPE_TAG_BOOLEAN:
+    case GI_TYPE_TAG_INT32:
+    case GI_TYPE_TAG_UNICHAR:
+      memcpy(ypush_i(dims), data, len*sz);
+      break;
+    case GI_TYPE_TAG_UINT32: {
+      long * out = ypush_l(dims);
+      for (i=0; i<len; ++i) out[i] = ((guint32*)data)[i];
+      break;
+    }
+    case GI_TYPE_TAG_FLOAT:
+      memcpy(ypush_f(dims), data, len*sz);
+      break;
+    case GI_TYPE_TAG_DOUBLE:
+      memcpy(ypush_d(dims), data, len*sz);
+      break;
+    case GI_TYPE_TAG_INT64:
+    case GI_TYPE_TAG_UINT64: {
+      long * out = ypush_l(dims);
+      for (i=0; i<len; ++i) out[i] = ((gint64*)data)[i];
+      break;
+    }
+    case GI_TYPE_TAG_GTYPE: {
+      long * out = ypush_l(dims);
+      for (i=0; i<len; ++i) out[i] = ((GType*)data)[i];
+      break;
+    }
+    default: {
+      // strings
+      char ** out = ypush_q(dims);
+      for (i=0; i<len; ++i) out[i] = p_strcpy(((gchar**)data)[i]);
+    }
+    }
+
+  if (!arg->v_pointer || transfer == GI_TRANSFER_NOTHING) return;
+  if (transfer == GI_TRANSFER_EVERYTHING &&
+      (ctag == GI_TYPE_TAG_UTF8 || ctag == GI_TYPE_TAG_FILENAME))
+    for (i=0; i<len; ++i) g_free(((gchar**)data)[i]);
+  switch (atype) {
+  case GI_ARRAY_TYPE_ARRAY:
+    g_array_unref(arg->v_pointer);
+    break;
+  case GI_ARRAY_TYPE_PTR_ARRAY:
+    g_ptr_array_unref(arg->v_pointer);
+    break;
+  case GI_ARRAY_TYPE_BYTE_ARRAY:
+    g_byte_array_unref(arg->v_pointer);
+    break;
+  default:
+    g_free(arg->v_pointer);
+  }
+}
+
+/* Input C array ARG of NTOT elements points to Yorick memory: give
+   the callee a copy it may free, according to TRANSFER. */
+void
+gy_Argument_array_own(GIArgument * arg, GITypeInfo * info, long ntot,
+		      GITransfer transfer)
+{
+  GITypeTag ctag = gy_array_cell_tag(info);
+  gsize sz = gy_type_tag_size(ctag);
+  long n = ntot + (g_type_info_is_zero_terminated(info) ? 1 : 0), i;
+  if (!arg->v_pointer || transfer == GI_TRANSFER_NOTHING) return;
+  if (g_type_info_get_array_type(info) != GI_ARRAY_TYPE_C)
+    y_error("unimplemented: transfer of non-C array");
+  gpointer copy = g_malloc(n*sz);
+  memcpy(copy, arg->v_pointer, n*sz);
+  arg->v_pointer = copy;
+  if (transfer == GI_TRANSFER_EVERYTHING &&
+      (ctag == GI_TYPE_TAG_UTF8 || ctag == GI_TYPE_TAG_FILENAME))
+    for (i=0; i<ntot; ++i)
+      ((gchar**)arg->v_pointer)[i] = g_strdup(((gchar**)arg->v_pointer)[i]);
+}
+
+/* Integer value of ARG, used for array lengths. */
+long
+gy_Argument_get_long(GIArgument * arg, GITypeInfo * info)
+{
+  switch (g_type_info_get_tag(info)) {
+  case GI_TYPE_TAG_INT8:   return arg->v_int8;
+  case GI_TYPE_TAG_UINT8:  return arg->v_uint8;
+  case GI_TYPE_TAG_INT16:  return arg->v_int16;
+  case GI_TYPE_TAG_UINT16: return arg->v_uint16;
+  case GI_TYPE_TAG_INT32:  return arg->v_int32;
+  case GI_TYPE_TAG_UINT32: return arg->v_uint32;
+  case GI_TYPE_TAG_INT64:  return arg->v_int64;
+  case GI_TYPE_TAG_UINT64: return arg->v_uint64;
+  default:
+    y_error("array length is not an integer");
+  }
+  return 0;
+}
+
+void
+gy_Argument_set_long(GIArgument * arg, GITypeInfo * info, long value)
+{
+  switch (g_type_info_get_tag(info)) {
+  case GI_TYPE_TAG_INT8:   arg->v_int8   = value; break;
+  case GI_TYPE_TAG_UINT8:  arg->v_uint8  = value; break;
+  case GI_TYPE_TAG_INT16:  arg->v_int16  = value; break;
+  case GI_TYPE_TAG_UINT16: arg->v_uint16 = value; break;
+  case GI_TYPE_TAG_INT32:  arg->v_int32  = value; break;
+  case GI_TYPE_TAG_UINT32: arg->v_uint32 = value; break;
+  case GI_TYPE_TAG_INT64:  arg->v_int64  = value; break;
+  case GI_TYPE_TAG_UINT64: arg->v_uint64 = value; break;
+  default:
+    y_error("array length is not an integer");
+  }
+}
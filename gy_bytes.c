@@ -0,0 +1,155 @@
+/*
+    Copyright 2013 Thibaut Paumard
+
+    This file is part of gy (GObject Introspection for Yorick).
+
+    Gyoto is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gyoto is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gy.h"
+
+/// GBYTES
+
+/*
+  gy_bytes wraps the memory of a Yorick array in a GBytes without
+  copying it. The GBytes holds a use of the array, dropped when the
+  last reference to the GBytes goes away. GIO may release it from a
+  worker thread: since the Yorick interpreter is not thread-safe, the
+  use is then queued and dropped on the interpreter thread, from the
+  GLib main loop (which only runs while gy_gtk_idler or a Gtk main
+  loop does) or at the next call to gy_bytes, whichever comes first.
+  Without either, the array stays alive.
+
+  GLib considers the content of a GBytes immutable (e.g. GVariants
+  built on it may have been validated once), while the Yorick array
+  can still be modified in place: this is the caller's business.
+ */
+
+static GThread * gy_bytes_thread = NULL;
+static GAsyncQueue * gy_bytes_pending = NULL;
+
+/* Drop the uses released from other threads. */
+static void
+gy_bytes_flush(void)
+{
+  gpointer use;
+  if (!gy_bytes_pending) return;
+  while ((use = g_async_queue_try_pop(gy_bytes_pending))) ydrop_use(use);
+}
+
+static gboolean
+gy_bytes_drop_idle(gpointer unused)
+{
+  gy_bytes_flush();
+  return FALSE;
+}
+
+static void
+gy_bytes_drop(gpointer use)
+{
+  if (g_thread_self() == gy_bytes_thread) ydrop_use(use);
+  else {
+    g_async_queue_push(gy_bytes_pending, use);
+    g_idle_add(gy_bytes_drop_idle, NULL);
+  }
+}
+
+/* Size in bytes of the elements of a Yorick array of type TYPEID, 0
+   if it has no flat representation. */
+static gsize
+gy_typeid_size(int typeid)
+{
+  switch (typeid) {
+  case Y_CHAR:    return sizeof(char);
+  case Y_SHORT:   return sizeof(short);
+  case Y_INT:     return sizeof(int);
+  case Y_LONG:    return sizeof(long);
+  case Y_FLOAT:   return sizeof(float);
+  case Y_DOUBLE:  return sizeof(double);
+  case Y_COMPLEX: return 2*sizeof(double);
+  default:        return 0;
+  }
+}
+
+gboolean
+gy_type_is_bytes(GITypeInfo * info)
+{
+  GIBaseInfo * itrf;
+  gboolean res = 0;
+  if (g_type_info_get_tag(info) != GI_TYPE_TAG_INTERFACE) return 0;
+  itrf = g_type_info_get_interface(info);
+  if (GI_IS_STRUCT_INFO(itrf))
+    res = g_registered_type_info_get_g_type(itrf) == G_TYPE_BYTES;
+  g_base_info_unref(itrf);
+  return res;
+}
+
+/* Push the content of BYTES as a char array (nil if empty). Yorick
+   arrays own their memory, so this is the one copy. */
+void
+gy_bytes_push(GBytes * bytes)
+{
+  gsize size = 0;
+  gconstpointer data = bytes ? g_bytes_get_data(bytes, &size) : NULL;
+  if (!size) {
+    ypush_nil();
+    return;
+  }
+  long dims[Y_DIMSIZE] = {1, size};
+  memcpy(ypush_c(dims), data, size);
+}
+
+/* New GBytes wrapping the memory of numeric array IARG. */
+GBytes *
+gy_bytes_get(int iarg)
+{
+  long ntot = 0;
+  int typeid;
+  gsize size;
+  gpointer data, use;
+
+  if (yarg_nil(iarg)) return g_bytes_new(NULL, 0);
+  if (!gy_bytes_thread) {
+    gy_bytes_thread = g_thread_self();
+    gy_bytes_pending = g_async_queue_new();
+  }
+  gy_bytes_flush();
+  // a scalar lives in the stack slot: take the use first, it holds the
+  // array, and read the data from the array it holds
+  use = yget_use(iarg);
+  ypush_use(use);
+  data = ygeta_any(0, &ntot, NULL, &typeid);
+  yarg_drop(1);
+  if (!(size = gy_typeid_size(typeid))) {
+    ydrop_use(use);
+    y_error("expecting a numeric array");
+  }
+  return g_bytes_new_with_free_func(data, size*ntot, gy_bytes_drop, use);
+}
+
+void
+Y_gy_bytes(int argc)
+{
+  GIBaseInfo * info;
+
+  if (argc != 1) y_error("gy_bytes takes exactly one argument");
+  GBytes * bytes = gy_bytes_get(0);
+
+  info = gy_glib_info(G_TYPE_BYTES);
+
+  gy_Object * o = ypush_gy_Object();
+  o -> object = (GObject*) bytes;
+  o -> boxed = G_TYPE_BYTES;
+  if (info) o -> info = g_base_info_ref(info);
+}
@@ -0,0 +1,202 @@
+/*
+    Copyright 2013 Thibaut Paumard
+
+    This file is part of gy (GObject Introspection for Yorick).
+
+    Gyoto is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gyoto is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gy.h"
+#include <cairo.h>
+
+/// CAIRO
+
+/*
+  Yorick arrays as cairo image surfaces, to be painted from the "draw"
+  handler of a GtkDrawingArea. The cairo typelib only describes the
+  types, hence the few native entry points here.
+
+  int(width, height) arrays hold native-endian ARGB32 (or RGB24)
+  pixels, and char(width, height) arrays alpha masks (A8): the surface
+  uses their memory directly when cairo accepts the stride, which is
+  always the case for 32-bit pixels. The surface keeps the array alive
+  through a GBytes stored as user data. Other layouts are converted
+  into memory owned by the surface.
+ */
+
+static cairo_user_data_key_t gy_cairo_data_key;
+
+static GType
+gy_cairo_type(const char * name)
+{
+  GError * err = NULL;
+  GIBaseInfo * info;
+  GType gtype;
+
+  if (!g_irepository_require(NULL, "cairo", NULL, 0, &err))
+    y_error(err->message);
+  info = g_irepository_find_by_name(NULL, "cairo", name);
+  if (!info) y_errorq("cairo.%s not found", name);
+  gtype = g_registered_type_info_get_g_type(info);
+  g_base_info_unref(info);
+  return gtype;
+}
+
+/* Push surface SURF as a boxed cairo.Surface. */
+static void
+gy_cairo_push_surface(cairo_surface_t * surf)
+{
+  static GType gtype = 0;
+  if (!gtype) gtype = gy_cairo_type("Surface");
+  gy_Object * o = ypush_gy_Object();
+  o -> object = (GObject*) surf;
+  o -> boxed = gtype;
+  GIBaseInfo * info = gy_info_from_gtype(gtype);
+  if (info) o -> info = g_base_info_ref(info);
+}
+
+/* Pointer held by gy_Object IARG, which must be a cairo.NAME
+   (cairo.Context, or any of the cairo.*Surface for "Surface"). */
+static gpointer
+gy_cairo_get(int iarg, const char * name)
+{
+  gy_Object * o = yget_gy_Object(iarg);
+  gboolean ok = FALSE;
+  if (o->info && GI_IS_REGISTERED_TYPE_INFO(o->info))
+    ok = !strcmp(g_base_info_get_namespace(o->info), "cairo") &&
+      g_str_has_suffix(g_base_info_get_name(o->info), name);
+  else if (o->boxed)
+    ok = g_type_is_a(o->boxed, gy_cairo_type(name));
+  if (!ok) y_errorq("expecting a cairo.%s", name);
+  if (!o->object) y_errorq("NULL cairo.%s", name);
+  return o->object;
+}
+
+void
+Y_gy_cairo_surface(int argc)
+{
+  long dims[Y_DIMSIZE], ntot, i;
+  int typeid, iarg = argc-1, width, height, stride;
+  cairo_format_t format;
+  cairo_surface_t * surf;
+  cairo_status_t status;
+  guint8 * data, * buf;
+  GBytes * bytes;
+
+  if (argc < 1 || argc > 2)
+    y_error("gy_cairo_surface takes 1 or 2 arguments");
+  data = ygeta_any(iarg, &ntot, dims, &typeid);
+
+  if (typeid == Y_INT && dims[0] == 2) {
+    format = CAIRO_FORMAT_ARGB32;
+    if (argc == 2 && !yarg_nil(0)) {
+      const char * fmt = ygets_q(0);
+      if (!g_ascii_strcasecmp(fmt, "RGB24")) format = CAIRO_FORMAT_RGB24;
+      else if (g_ascii_strcasecmp(fmt, "ARGB32"))
+	y_errorq("unsupported format for int image: %s", fmt);
+    }
+  } else if (typeid == Y_CHAR && dims[0] == 2)
+    format = CAIRO_FORMAT_A8;
+  else if (typeid == Y_CHAR && dims[0] == 3 && dims[1] == 3)
+    format = CAIRO_FORMAT_RGB24;
+  else if (typeid == Y_CHAR && dims[0] == 3 && dims[1] == 4)
+    format = CAIRO_FORMAT_ARGB32;
+  else
+    y_error("image must be int(width, height), char(width, height) "
+	    "or char(3|4, width, height)");
+
+  width = dims[dims[0]-1];
+  height = dims[dims[0]];
+  stride = cairo_format_stride_for_width(format, width);
+
+  if (dims[0] == 2 && stride == width * (typeid == Y_INT ? 4 : 1)) {
+    // wrap the Yorick array, kept alive by the bytes
+    bytes = gy_bytes_get(iarg);
+    surf = cairo_image_surface_create_for_data
+      ((guint8*) g_bytes_get_data(bytes, NULL), format,
+       width, height, stride);
+    // an error surface does not call the destroy function
+    if ((status = cairo_surface_status(surf)) != CAIRO_STATUS_SUCCESS ||
+	(status = cairo_surface_set_user_data
+	 (surf, &gy_cairo_data_key, bytes,
+	  (cairo_destroy_func_t) g_bytes_unref)) != CAIRO_STATUS_SUCCESS) {
+      g_bytes_unref(bytes);
+      cairo_surface_destroy(surf);
+      y_error(cairo_status_to_string(status));
+    }
+  } else {
+    surf = cairo_image_surface_create(format, width, height);
+    buf = cairo_image_surface_get_data(surf);
+    if (!buf) {
+      cairo_surface_destroy(surf);
+      y_error("could not create cairo surface");
+    }
+    cairo_surface_flush(surf);
+    if (dims[0] == 2) {
+      // A8 with padded rows
+      for (i=0; i<height; ++i)
+	memcpy(buf+i*stride, data+i*width, width);
+    } else {
+      guint32 * px;
+      guint8 * p = data;
+      long x, y;
+      guint32 a, r, g, b;
+      for (y=0; y<height; ++y) {
+	px = (guint32*)(buf+y*stride);
+	for (x=0; x<width; ++x) {
+	  r = *p++; g = *p++; b = *p++;
+	  if (dims[1] == 4) {
+	    // cairo wants premultiplied alpha
+	    a = *p++;
+	    r = (r*a+127)/255;
+	    g = (g*a+127)/255;
+	    b = (b*a+127)/255;
+	  } else a = 255;
+	  px[x] = a<<24 | r<<16 | g<<8 | b;
+	}
+      }
+    }
+    cairo_surface_mark_dirty(surf);
+  }
+
+  if ((status = cairo_surface_status(surf)) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(surf);
+    y_error(cairo_status_to_string(status));
+  }
+  gy_cairo_push_surface(surf);
+}
+
+void
+Y_gy_cairo_paint(int argc)
+{
+  double x = 0., y = 0., scale = 1.;
+
+  if (argc < 2 || argc > 5)
+    y_error("gy_cairo_paint takes 2 to 5 arguments");
+  cairo_t * cr = gy_cairo_get(argc-1, "Context");
+  cairo_surface_t * surf = gy_cairo_get(argc-2, "Surface");
+  if (argc > 2 && !yarg_nil(argc-3)) x = ygets_d(argc-3);
+  if (argc > 3 && !yarg_nil(argc-4)) y = ygets_d(argc-4);
+  if (argc > 4 && !yarg_nil(argc-5)) scale = ygets_d(argc-5);
+
+  // the surface may wrap a Yorick array modified since last time
+  cairo_surface_mark_dirty(surf);
+  cairo_save(cr);
+  cairo_translate(cr, x, y);
+  if (scale != 1.) cairo_scale(cr, scale, scale);
+  cairo_set_source_surface(cr, surf, 0., 0.);
+  cairo_paint(cr);
+  cairo_restore(cr);
+  ypush_nil();
+}
@@ -19,211 +19,258 @@
 
 #include "gy.h"
 
-void gy_callback0(void* arg1, gy_signal_data* sd) {
-  GY_DEBUG("in gy_callback0()\n");
-  const char * cmd = sd -> cmd;
-  GISignalInfo * cbinfo = sd -> info;
-  GIRepository * repo = sd -> repo;
-  void * data = sd -> data;
-  //  void * udata = sd -> data;
-  GY_DEBUG("Callback called with pointer %p: \"%s\"\n", cmd, (char*)cmd);
-  char*buf=NULL;
-  int ndrops=0;
-
-  ypush_check(4);
-
-  long idx1=0, idxud=0;
-
-  if (cbinfo) {
-    const char * var1 = "__gy_callback_var1";
-    const char * varud = "__gy_callback_userdata";
-    idx1 = yget_global(var1, 0);
-    idxud = yget_global(varud, 0);
-
-    gy_Object * o1 = ypush_gy_Object();
-    yput_global(idx1, 0);
+/// CALLBACKS
+
+/*
+  Handlers are GClosures with a generic marshaller, so that signals of
+  any arity and return type are supported. The handler is resolved when
+  the signal is connected: a named handler to the index of the global
+  variable holding it (so that it can still be redefined), an anonymous
+  one to a use of the function. On delivery, the handler and its
+  arguments are pushed on the stack and called directly with
+  yexec_call, without going through the parser. Handlers given as
+  other strings (expressions such as "obj.method") still go through
+  the parser with yexec_include, at each call.
+
+  Each argument is converted according to its type: numbers, strings
+  and enums become Yorick values through the GValue converters (cached
+  in the gy_Signal on first use), the instance and other objects lazy
+  gy objects. Structures (events, cairo contexts...) are wrapped with
+  the type the signal declares, e.g. Gdk.EventButton rather than
+  Gdk.Event, holding a copy when the value is boxed. The wrapper for the
+  user data never changes and is built once; the others are fresh at
+  each call since the handler may keep them.
+ */
+
+static void
+gy_callback_clear_pending(gy_signal_data * sd)
+{
+  guint i;
+  if (!sd->pending) return;
+  for (i=0; i<=sd->signal->nargs; ++i)
+    if (G_IS_VALUE(sd->pending+i)) g_value_unset(sd->pending+i);
+  sd -> n_pending = 0;
+}
+
+static void
+gy_signal_data_free(gpointer data, GClosure * closure)
+{
+  gy_signal_data * sd = data;
+  if (sd->source) g_source_remove(sd->source);
+  gy_callback_clear_pending(sd);
+  g_free(sd->pending);
+  if (sd->func) ydrop_use(sd->func);
+  if (sd->udata) ydrop_use(sd->udata);
+  if (sd->cmd) p_free((char*) sd->cmd);
+  g_free(sd);
+}
 
-    o1 -> object = arg1;
-    o1 -> repo = repo;
-    g_object_ref(o1 -> object);
-    o1 -> info =
-	  g_irepository_find_by_gtype(o1 -> repo,
-				      G_OBJECT_TYPE(o1 -> object));
-
-    gy_Object * oud = ypush_gy_Object();
-    yput_global(idxud, 0);
-    oud -> object = data;
-    oud -> repo = repo;
-
-    const char * fmt = "__gy_callback_retval = %s (%s, %s)";
-    char * buf=p_malloc(sizeof(char)*
-			(strlen(fmt)+strlen(cmd)+strlen(var1)+strlen(varud)));
-    sprintf(buf, fmt, cmd, var1, varud);
-    cmd=buf;
-    ndrops+=1;
+/* Push parameter I (0 is the instance) of value VAL. */
+static void
+gy_callback_push_param(gy_signal_data * sd, guint i, GValue * val)
+{
+  gy_Signal * sig = sd->signal;
+  GIBaseInfo * info = i ? sig->arginfos[i-1] : NULL;
+  gy_Object ctx = {0}, * o;
+
+  if (info && (G_VALUE_HOLDS_BOXED(val) || G_VALUE_HOLDS_POINTER(val))) {
+    gpointer ptr = G_VALUE_HOLDS_BOXED(val) ?
+      g_value_get_boxed(val) : g_value_get_pointer(val);
+    if (!ptr) {
+      ypush_nil();
+      return;
+    }
+    o = ypush_gy_Object();
+    o -> info = g_base_info_ref(info);
+    o -> repo = sd->repo;
+    if (G_VALUE_HOLDS_BOXED(val)) {
+      o -> object = g_value_dup_boxed(val);
+      o -> boxed = G_VALUE_TYPE(val);
+    } else o -> object = ptr;
+    return;
   }
 
-  long dims[2]={1,1};
-  *ypush_q(dims) = p_strcpy(cmd);
-  ++ndrops;
-  if (buf) p_free(buf);
-  yexec_include(0,1);
-  yarg_drop(ndrops);
+  if (!sig->convs[i]) sig->convs[i] = gy_value_conv_for(G_VALUE_TYPE(val));
+  if (sig->convs[i]) {
+    ctx.repo = sd->repo;
+    sig->convs[i]->push(sig->convs[i], val, &ctx);
+    return;
+  }
 
+  // no converter (e.g. GParamSpec): untyped wrapper
+  o = ypush_gy_Object();
+  o -> object = g_value_peek_pointer(val);
+  o -> repo = sd->repo;
 }
 
-inline gboolean gy_callback_retbool() {
-  long idx=yget_global("__gy_callback_retval", 0);
-  ypush_check(1);
-  ypush_global(idx);
-  long retval=0;
-  if (yarg_number(0)) retval=ygets_l(0);
-  yarg_drop(1);
-  return retval;
+/* Whether the result of a handler, on top of the stack, can be
+   converted to the return type GTYPE of a signal. Other results (nil,
+   or e.g. the string returned by the last statement) leave the default
+   value of the signal. */
+static gboolean
+gy_callback_result_fits(GType gtype)
+{
+  switch (G_TYPE_FUNDAMENTAL(gtype)) {
+  case G_TYPE_OBJECT:
+  case G_TYPE_INTERFACE:
+  case G_TYPE_BOXED:
+    return yarg_gy_Object(0);
+  case G_TYPE_STRING:
+    return yarg_string(0) == 1;
+  default:
+    return yarg_number(0) && !yarg_rank(0);
+  }
 }
 
-gboolean gy_callback0_bool(void* arg1, gy_signal_data* sd) {
-  gy_callback0(arg1, sd) ;
-  return gy_callback_retbool();
+/* Evaluate the expression handler of SD on the N parameters and the
+   user data on top of the stack, which are replaced by the result.
+   The arguments go through global variables since the expression is
+   parsed. */
+static void
+gy_callback_include(gy_signal_data * sd, guint n)
+{
+  GString * expr = g_string_new("__gy_callback_retval = ");
+  gchar name[32];
+  guint i;
+
+  g_string_append_printf(expr, "%s(", sd->cmd);
+  for (i=0; i<n; ++i) {
+    g_snprintf(name, sizeof(name), "__gy_callback_var%u", i+1);
+    yput_global(yget_global(name, 0), n-i);
+    g_string_append_printf(expr, "%s, ", name);
+  }
+  yput_global(yget_global("__gy_callback_userdata", 0), 0);
+  g_string_append(expr, "__gy_callback_userdata)");
+  yarg_drop(n+1);
+
+  long dims[Y_DIMSIZE] = {1, 1};
+  *ypush_q(dims) = p_strcpy(expr->str);
+  g_string_free(expr, TRUE);
+  yexec_include(0, 1);
+  yarg_drop(1);
+  ypush_global(yget_global("__gy_callback_retval", 0));
 }
 
-void gy_callback1(void* arg1, void* arg2, gy_signal_data* sd) {
-  const char * cmd = sd -> cmd;
-  GISignalInfo * cbinfo = sd -> info;
-  GIRepository * repo = sd -> repo;
-  void * data = sd -> data;
-  //void * udata = sd -> data;
-  GY_DEBUG("Callback called with pointer %p: \"%s\"\n", cmd, (char*)cmd);
-  char*buf=NULL;
-  int ndrops=0;
-
-  ypush_check(4);
-
-  long idx1=0, idx2=0, idxud=0;
-
-  if (cbinfo) {
-    const char * var1 = "__gy_callback_var1";
-    const char * var2 = "__gy_callback_var2";
-    const char * varud = "__gy_callback_userdata";
-    idx1 = yget_global(var1, 0);
-    idx2 = yget_global(var2, 0);
-    idxud = yget_global(varud, 0);
-
-    gy_Object * o1 = ypush_gy_Object();
-    yput_global(idx1, 0);
-    gy_Object * o2 = ypush_gy_Object();
-    yput_global(idx2, 0);
-
-    o1 -> object = arg1;
-    o1 -> repo = repo;
-    g_object_ref(o1 -> object);
-    o1 -> info =
-	  g_irepository_find_by_gtype(o1 -> repo,
-				      G_OBJECT_TYPE(o1 -> object));
-
-    o2 -> object = arg2;
-    o2 -> repo = repo;
-
-    gy_Object * oud = ypush_gy_Object();
-    yput_global(idxud, 0);
-    oud -> object = data;
-    oud -> repo = repo;
-
-    const char * fmt = "__gy_callback_retval = %s (%s, %s, %s)";
-    char * buf=p_malloc(sizeof(char)*
-			(strlen(fmt)+strlen(cmd)+strlen(var1)+strlen(var2)
-			 +strlen(varud)));
-    sprintf(buf, fmt, cmd, var1, var2, varud);
-    cmd=buf;
-    ndrops+=2;
+/* Call the handler of SD with the N parameters in VALUES and the user
+   data, storing its result in RETURN_VALUE if not NULL. */
+static void
+gy_callback_deliver(gy_signal_data * sd, guint n, GValue * values,
+		    GValue * return_value)
+{
+  gy_Signal * sig = sd->signal;
+  gy_Object * o;
+  guint i;
+
+  GY_DEBUG("Callback %s called with %u arguments\n",
+	   sd->cmd ? sd->cmd : "(anonymous)", n);
+
+  if (n > sig->nargs+1) n = sig->nargs+1;
+  ypush_check(n+2);
+
+  if (sd->func) ypush_use(sd->func);
+  else if (sd->idx >= 0) ypush_global(sd->idx);
+
+  for (i=0; i<n; ++i)
+    gy_callback_push_param(sd, i, values+i);
+
+  if (!sd->udata) {
+    o = ypush_gy_Object();
+    o -> object = sd->data;
+    o -> repo = sd->repo;
+    sd -> udata = yget_use(0);
+  } else ypush_use(sd->udata);
+
+  if (sd->func || sd->idx >= 0) yexec_call(n+1);
+  else gy_callback_include(sd, n);
+
+  if (return_value && G_IS_VALUE(return_value) &&
+      gy_callback_result_fits(G_VALUE_TYPE(return_value))) {
+    if (!sig->retconv)
+      sig->retconv = gy_value_conv_for(G_VALUE_TYPE(return_value));
+    if (sig->retconv) sig->retconv->set(sig->retconv, return_value, 0);
   }
+  yarg_drop(1);
+}
+
+/// COALESCING
+
+/*
+  Handlers connected with coalesce= or debounce= do not run during the
+  emission. The parameters are copied, replacing those of the emission
+  still pending if any, and the handler runs once with the latest ones:
+  from an idle source (coalesce), i.e. at most once per main loop
+  iteration, or when no emission happened for the debounce delay (a
+  timeout restarted at each emission). Raw pointers do not survive the
+  emission and are passed as NULL. Since the handler runs later, its
+  result is ignored and the signal returns its default value.
+ */
 
-  long dims[2]={1,1};
-  *ypush_q(dims) = p_strcpy(cmd);
-  ++ndrops;
-  if (buf) p_free(buf);
-  yexec_include(0,1);
-  yarg_drop(ndrops);
+typedef struct _gy_Delivery {
+  guint n;
+  GValue * values;
+} gy_Delivery;
 
+static void
+gy_Delivery_free(void * obj)
+{
+  gy_Delivery * d = obj;
+  guint i;
+  for (i=0; i<d->n; ++i)
+    if (G_IS_VALUE(d->values+i)) g_value_unset(d->values+i);
+  g_free(d->values);
 }
 
-gboolean gy_callback1_bool(void* arg1, void* arg2, gy_signal_data* sd) {
-  gy_callback1(arg1, arg2, sd) ;
-  return gy_callback_retbool();
+static gboolean
+gy_callback_flush(gpointer data)
+{
+  gy_signal_data * sd = data;
+  gy_Delivery * d;
+  sd -> source = 0;
+  if (!sd->n_pending) return FALSE;
+  // the handler may cause new emissions, which must stay pending: take
+  // the parameters out of SD, they are released even on error
+  d = ypush_scratch(sizeof(gy_Delivery), &gy_Delivery_free);
+  d -> values = g_new0(GValue, sd->n_pending);
+  memcpy(d->values, sd->pending, sd->n_pending*sizeof(GValue));
+  memset(sd->pending, 0, sd->n_pending*sizeof(GValue));
+  d -> n = sd->n_pending;
+  sd -> n_pending = 0;
+  gy_callback_deliver(sd, d->n, d->values, NULL);
+  yarg_drop(1);
+  return FALSE;
 }
 
-void gy_callback2(void* arg1, void* arg2, void* arg3, gy_signal_data* sd) {
-  const char * cmd = sd -> cmd;
-  GISignalInfo * cbinfo = sd -> info;
-  GIRepository * repo = sd -> repo;
-  void * data = sd -> data;
-  // void * udata = sd -> data;
-  GY_DEBUG("Callback called with pointer %p: \"%s\"\n", cmd, (char*)cmd);
-  char*buf=NULL;
-  int ndrops=0;
-
-  ypush_check(5);
-
-  long idx1=0, idx2=0, idx3=0, idxud=0;
-
-  if (cbinfo) {
-    const char * var1 = "__gy_callback_var1";
-    const char * var2 = "__gy_callback_var2";
-    const char * var3 = "__gy_callback_var3";
-    const char * varud = "__gy_callback_userdata";
-    idx1 = yget_global(var1, 0);
-    idx2 = yget_global(var2, 0);
-    idx3 = yget_global(var3, 0);
-    idxud = yget_global(varud, 0);
-
-    gy_Object * o1 = ypush_gy_Object();
-    yput_global(idx1, 0);
-    gy_Object * o2 = ypush_gy_Object();
-    yput_global(idx2, 0);
-    gy_Object * o3 = ypush_gy_Object();
-    yput_global(idx3, 0);
-
-    o1 -> object = arg1;
-    o1 -> repo = repo;
-    g_object_ref(o1 -> object);
-    o1 -> info =
-	  g_irepository_find_by_gtype(o1 -> repo,
-				      G_OBJECT_TYPE(o1 -> object));
-
-    o2 -> object = arg2;
-    o2 -> repo = repo;
-    o3 -> object = arg3;
-    o3 -> repo = repo;
-
-
-    gy_Object * oud = ypush_gy_Object();
-    yput_global(idxud, 0);
-    oud -> object = data;
-    oud -> repo = repo;
-
-    const char * fmt = "__gy_callback_retval = %s (%s, %s, %s, %s)";
-    char * buf=p_malloc(sizeof(char)*
-			(strlen(fmt)+strlen(cmd)
-			 +strlen(var1)+strlen(var2)+strlen(var3)
-			 +strlen(varud)));
-    sprintf(buf, fmt, cmd, var1, var2, var3, varud);
-    cmd=buf;
-    ndrops+=3;
+static void
+gy_callback_defer(gy_signal_data * sd, guint n, const GValue * values)
+{
+  guint i;
+
+  if (n > sd->signal->nargs+1) n = sd->signal->nargs+1;
+  if (!sd->pending) sd->pending = g_new0(GValue, sd->signal->nargs+1);
+  gy_callback_clear_pending(sd);
+  for (i=0; i<n; ++i) {
+    g_value_init(sd->pending+i, G_VALUE_TYPE(values+i));
+    if (!G_VALUE_HOLDS_POINTER(values+i))
+      g_value_copy(values+i, sd->pending+i);
   }
+  sd -> n_pending = n;
 
-  long dims[2]={1,1};
-  *ypush_q(dims) = p_strcpy(cmd);
-  ++ndrops;
-  if (buf) p_free(buf);
-  yexec_include(0,1);
-  yarg_drop(ndrops);
-
+  if (sd->delay > 0) {
+    if (sd->source) g_source_remove(sd->source);
+    sd -> source = g_timeout_add(sd->delay, &gy_callback_flush, sd);
+  } else if (!sd->source)
+    sd -> source = g_idle_add(&gy_callback_flush, sd);
 }
 
-gboolean gy_callback2_bool(void* arg1, void* arg2, void*arg3,
-			   gy_signal_data* sd) {
-  gy_callback2(arg1, arg2, arg3, sd) ;
-  return gy_callback_retbool();
+static void
+gy_callback_marshal(GClosure * closure, GValue * return_value,
+		    guint n_param_values, const GValue * param_values,
+		    gpointer hint, gpointer marshal_data)
+{
+  gy_signal_data * sd = closure->data;
+  if (sd->delay >= 0) gy_callback_defer(sd, n_param_values, param_values);
+  else gy_callback_deliver(sd, n_param_values, (GValue*) param_values,
+			   return_value);
 }
 
 ///// end callbacks
@@ -234,17 +281,53 @@ __gy_signal_connect(GObject * object,
 		    GIRepository * repo,
 		    const gchar* sig,
 		    const gchar * cmd,
-		    void * data);
+		    void * func,
+		    void * data,
+		    gint delay);
+
+/* Whether NAME may be the name of a Yorick variable. */
+static gboolean
+gy_is_identifier(const char * name)
+{
+  if (!name || !(g_ascii_isalpha(*name) || *name == '_')) return FALSE;
+  while (*++name)
+    if (!(g_ascii_isalnum(*name) || *name == '_')) return FALSE;
+  return TRUE;
+}
 
 void
 Y_gy_signal_connect(int argc) {
-  gy_Object * o = yget_gy_Object(argc-1);
-  if (!o->info || !GI_IS_OBJECT_INFO(o->info) || ! o -> object )
+  static char * knames[] = {"coalesce", "debounce", 0};
+  static long kglobs[3];
+  int kiargs[2], pos[4], npos = 0, iarg;
+  gint delay = -1;
+
+  yarg_kw_init(knames, kglobs, kiargs);
+  for (iarg=argc-1; iarg>=0; ) {
+    iarg = yarg_kw(iarg, kglobs, kiargs);
+    if (iarg >= 0) {
+      if (npos < 4) pos[npos] = iarg;
+      ++npos;
+      --iarg;
+    }
+  }
+  if (npos < 1 || npos > 4)
+    y_error("gy_signal_connect takes 1 to 4 positional arguments");
+  if (kiargs[0] >= 0 && yarg_true(kiargs[0])) delay = 0;
+  if (kiargs[1] >= 0 && !yarg_nil(kiargs[1])) {
+    double t = ygets_d(kiargs[1]);
+    if (t < 0) y_error("debounce must be >= 0");
+    delay = t > 0 ? (gint) (t*1000.+0.5) : 0;
+    if (t > 0 && !delay) delay = 1;
+  }
+
+  gy_Object * o = yget_gy_Object(pos[0]);
+  if (!gy_Object_resolve(o) || !GI_IS_OBJECT_INFO(o->info) || ! o -> object )
     y_error("First argument but hold GObject derivative instance");
 
   if (!strcmp(G_OBJECT_TYPE_NAME(o->object), "GtkBuilder")) {
     long idx1 = yget_global("__gy_gtk_builder", 0);
-    void* usage=yget_use(argc-1);
+    void* usage=yget_use(pos[0]);
     ypush_use(usage);
     yput_global(idx1, 0);
     long dims[Y_DIMSIZE]={1,1};
@@ -255,98 +338,172 @@ Y_gy_signal_connect(int argc) {
     ypush_nil();
     return;
   }
+  if (npos < 3) y_error("gy_signal_connect needs object, signal, handler");
 
-  ystring_t sig = ygets_q(argc-2);
+  ystring_t sig = ygets_q(pos[1]);
   ystring_t cmd = NULL;
-
-  if (yarg_string(argc-3)) cmd = p_strcpy(ygets_q(argc-3));
-  else if (yarg_func(argc-3)) {
-    cmd = p_strcpy(yfind_name(yget_ref(argc-3)));
+  void * func = NULL;
+  long ref;
+
+  if (yarg_string(pos[2])) {
+    cmd = ygets_q(pos[2]);
+  } else if (yarg_func(pos[2])) {
+    if ((ref = yget_ref(pos[2])) >= 0) cmd = yfind_name(ref);
+    else func = yget_use(pos[2]);
   } else y_error("callback must be string or function");
 
-  void* data;
-  if (argc>=4) data = yget_gy_Object(argc-4)->object; 
+  void* data = NULL;
+  if (npos>=4) data = yget_gy_Object(pos[3])->object; 
 
-  __gy_signal_connect(o->object, o->info, o->repo, sig, cmd, data);
+  __gy_signal_connect(o->object, o->info, o->repo, sig, cmd, func, data,
+		      delay);
 
   ypush_nil();
 }
 
-void
-__gy_signal_connect(GObject * object, GIBaseInfo * info, GIRepository * repo,
-		    const gchar * sig, const gchar * cmd, void * data)
+/// SIGNAL CACHE
+
+/*
+  Signals are looked up once per class and name; the resulting
+  gy_Signal holds everything needed to connect a handler and marshal
+  its arguments: the signal id and detail, the GISignalInfo, the
+  declared structure type of each argument and the GValue converters.
+ */
+
+/* Look for signal NAME (canonical, without detail) in object or
+   interface INFO, its interfaces and ancestors. */
+static GISignalInfo *
+gy_Signal_find_info(GIBaseInfo * info, const gchar * name)
 {
-  GIBaseInfo * cur, *next;
-  GISignalInfo * cbinfo=NULL;
+  GISignalInfo * si;
+  GIBaseInfo * sub;
   gint i, n;
+  gboolean isobject = GI_IS_OBJECT_INFO(info);
+
+  n = isobject ?
+    g_object_info_get_n_signals(info) :
+    g_interface_info_get_n_signals(info);
+  for (i=0; i<n; ++i) {
+    si = isobject ?
+      g_object_info_get_signal(info, i) :
+      g_interface_info_get_signal(info, i);
+    if (!strcmp(g_base_info_get_name(si), name)) return si;
+    g_base_info_unref(si);
+  }
 
-  cur = info;
-  g_base_info_ref(cur);
-  while (!cbinfo && cur) {
-    GY_DEBUG("%s\n", g_base_info_get_name(cur) );
-    n= g_object_info_get_n_signals(cur);
-    for (i=0; i<n; ++i) {
-      cbinfo = g_object_info_get_signal(cur, i);
-      if (!strcmp(g_base_info_get_name(cbinfo), sig))
-	break;
-      g_base_info_unref(cbinfo);
-      cbinfo=NULL;
-    }
-    next = g_object_info_get_parent(cur);
-    g_base_info_unref(cur);
-    cur = next;
+  if (!isobject) return NULL;
+
+  si = NULL;
+  n = g_object_info_get_n_interfaces(info);
+  for (i=0; !si && i<n; ++i) {
+    sub = g_object_info_get_interface(info, i);
+    si = gy_Signal_find_info(sub, name);
+    g_base_info_unref(sub);
+  }
+  if (!si && (sub = g_object_info_get_parent(info))) {
+    si = gy_Signal_find_info(sub, name);
+    g_base_info_unref(sub);
   }
-  if (!cbinfo) y_errorq ("Object does not support signal \"%s\"", sig);
+  return si;
+}
 
-  gy_signal_data * sd = g_new0(gy_signal_data, 1);
+gy_Signal *
+gy_Class_find_signal(gy_Class * klass, const char * name)
+{
+  gy_Signal * sig;
+  GISignalInfo * info;
+  gchar * base, * sep;
+  gint i;
+
+  if (!GI_IS_OBJECT_INFO(klass->info) && !GI_IS_INTERFACE_INFO(klass->info))
+    return NULL;
+
+  if (!klass->signals) {
+    klass->signals = g_hash_table_new(g_str_hash, g_str_equal);
+    // signals are registered when the class is initialized
+    if (G_TYPE_IS_INTERFACE(klass->gtype))
+      g_type_default_interface_ref(klass->gtype);
+    else if (G_TYPE_IS_CLASSED(klass->gtype))
+      g_type_class_ref(klass->gtype);
+  } else if ((sig = g_hash_table_lookup(klass->signals, name)))
+    return sig;
+
+  base = g_strdup(name);
+  if ((sep = strstr(base, "::"))) *sep = '\0';
+  g_strdelimit(base, "_", '-');
+  info = gy_Signal_find_info(klass->info, base);
+  g_free(base);
+  if (!info) return NULL;
+
+  sig = g_new0(gy_Signal, 1);
+  sig -> info = info;
+  sig -> name = g_intern_string(name);
+  if (klass->gtype != G_TYPE_NONE)
+    g_signal_parse_name(name, klass->gtype, &sig->id, &sig->detail, TRUE);
+
+  sig -> nargs = g_callable_info_get_n_args(info);
+  GITypeInfo * retinfo = g_callable_info_get_return_type(info);
+  sig -> rettag = g_type_info_get_tag(retinfo);
+  g_base_info_unref(retinfo);
 
-  GY_DEBUG("%p type: %s, name: %s, is signal info: %d, is callable: %d\n",
-	   cbinfo,
-	   g_info_type_to_string(g_base_info_get_type(cbinfo)),
-	   g_base_info_get_name(cbinfo),
-	   GI_IS_SIGNAL_INFO(cbinfo),
-	   GI_IS_CALLABLE_INFO(cbinfo));
+  // instance and arguments
+  sig -> convs = g_new0(const gy_ValueConv *, sig->nargs+1);
+  sig -> arginfos = g_new0(GIBaseInfo *, sig->nargs);
+  for (i=0; i<sig->nargs; ++i) {
+    GIArgInfo * ai = g_callable_info_get_arg(info, i);
+    GITypeInfo * ti = g_arg_info_get_type(ai);
+    if (g_type_info_get_tag(ti) == GI_TYPE_TAG_INTERFACE) {
+      GIBaseInfo * itrf = g_type_info_get_interface(ti);
+      if (GI_IS_STRUCT_INFO(itrf) || GI_IS_UNION_INFO(itrf))
+	sig -> arginfos[i] = itrf;
+      else g_base_info_unref(itrf);
+    }
+    g_base_info_unref(ti);
+    g_base_info_unref(ai);
+  }
 
-  sd -> info = cbinfo;
-  sd -> cmd = cmd;
-  sd -> repo = repo;
-  sd -> data = data;
+  GY_DEBUG("Caching signal %s of %s: id=%u, %d arguments\n",
+	   name, g_base_info_get_name(klass->info), sig->id, sig->nargs);
 
-  GCallback * voidcallbacks[]={(GCallback*)(&gy_callback0),
-			       (GCallback*)(&gy_callback1),
-			       (GCallback*)(&gy_callback2)};
-  GCallback * gbooleancallbacks[]={(GCallback*)(&gy_callback0_bool),
-				   (GCallback*)(&gy_callback1_bool),
-				   (GCallback*)(&gy_callback2_bool)};
+  g_hash_table_insert(klass->signals, (gpointer) sig->name, sig);
+  return sig;
+}
 
-  GCallback * * callbacks=NULL;
+/* Connect handler FUNC (a use, consumed) or, if FUNC is NULL, the
+   function named CMD to signal SIG of OBJECT. DELAY is -1 for
+   immediate delivery, 0 to coalesce emissions, else the debounce
+   delay in milliseconds. */
+void
+__gy_signal_connect(GObject * object, GIBaseInfo * info, GIRepository * repo,
+		    const gchar * sig, const gchar * cmd, void * func,
+		    void * data, gint delay)
+{
+  gy_Signal * signal = gy_Class_find_signal(gy_Class_get(info), sig);
 
-  gint nargs = g_callable_info_get_n_args (cbinfo);
-  GY_DEBUG("Callback takes %d arguments\n", nargs);
-  
-  GITypeInfo * retinfo = g_callable_info_get_return_type (cbinfo);
-  GITypeTag    rettag  = g_type_info_get_tag(retinfo); 
-  g_base_info_unref(retinfo);
-  switch(rettag) {
-  case GI_TYPE_TAG_VOID:
-    callbacks=voidcallbacks;
-    break;
-  case GI_TYPE_TAG_BOOLEAN:
-    callbacks=gbooleancallbacks;
-    break;
-  default:
-    y_errorq("unimplemented output type for callback: %",
-	     g_type_tag_to_string (rettag));
+  if (!signal) {
+    if (func) ydrop_use(func);
+    y_errorq ("Object does not support signal \"%s\"", sig);
   }
 
-  if (nargs>2) y_errorn("unimplemented: callback with %ld arguments", nargs);
+  gy_signal_data * sd = g_new0(gy_signal_data, 1);
+  sd -> info = signal->info;
+  sd -> signal = signal;
+  sd -> cmd = cmd ? p_strcpy(cmd) : NULL;
+  sd -> idx = func || !gy_is_identifier(cmd) ? -1 : yget_global(cmd, 0);
+  sd -> func = func;
+  sd -> repo = repo;
+  sd -> data = data;
+  sd -> delay = delay;
 
-  GY_DEBUG("Callback address: %p\n", callbacks[nargs]);
+  GClosure * closure = g_closure_new_simple(sizeof(GClosure), sd);
+  g_closure_add_finalize_notifier(closure, sd, &gy_signal_data_free);
+  g_closure_set_marshal(closure, &gy_callback_marshal);
 
-  g_signal_connect (object,
-		    sig,
-		    G_CALLBACK(callbacks[nargs]),
-		    sd);
+  if (signal->id)
+    g_signal_connect_closure_by_id(object, signal->id, signal->detail,
+				   closure, FALSE);
+  else
+    g_signal_connect_closure(object, sig, closure, FALSE);
 }
 
 void
@@ -360,13 +517,12 @@ gyGtkBuilderConnectFunc(void *builder,
 
 {
   // builder is a GtkBuilder but we don't want to use gtk headers
-  GIObjectInfo * info = g_irepository_find_by_gtype(NULL, // should use repo
-						    G_OBJECT_TYPE(object));
+  GIObjectInfo * info = gy_info_from_gtype(G_OBJECT_TYPE(object));
+  if (!info) y_errorq("unable to find object type for %s",
+		      G_OBJECT_TYPE_NAME(object));
   GY_DEBUG("autoconnecting %s to %s\n", signal_name, handler_name);
-  // ! we may leak memory
-  __gy_signal_connect(object, info, NULL, signal_name, p_strcpy(handler_name),
-		      user_data);
-  g_base_info_unref(info);
+  __gy_signal_connect(object, info, NULL, signal_name, handler_name, NULL,
+		      user_data, -1);
 }
 
 void
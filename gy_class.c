@@ -0,0 +1,350 @@
+/*
+    Copyright 2013 Thibaut Paumard
+
+    This file is part of gy (GObject Introspection for Yorick).
+
+    Gyoto is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gyoto is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gy.h"
+
+/// CLASS CACHE
+
+/*
+  One gy_Class is created for each registered type (object, interface,
+  struct, enum...) the first time a member is looked up in it. The
+  tables it holds are built lazily and kept for the whole session.
+
+  Classes are keyed by GType when the type is registered with GObject,
+  else by namespace and name (plain C structures often have no GType).
+ */
+
+static GHashTable * gy_classes_by_gtype = NULL;
+static GHashTable * gy_classes_by_name  = NULL;
+
+static gy_Class *
+gy_Class_new(GIBaseInfo * info, GType gtype)
+{
+  gy_Class * klass = g_new0(gy_Class, 1);
+  klass -> info  = g_base_info_ref(info);
+  klass -> gtype = gtype;
+  GY_DEBUG("New class cache for %s.%s\n",
+	   g_base_info_get_namespace(info),
+	   g_base_info_get_name(info));
+  return klass;
+}
+
+gy_Class *
+gy_Class_get(GIBaseInfo * info)
+{
+  gy_Class * klass;
+  GType gtype = G_TYPE_NONE;
+
+  if (GI_IS_REGISTERED_TYPE_INFO(info))
+    gtype = g_registered_type_info_get_g_type(info);
+
+  if (gtype != G_TYPE_NONE && gtype != G_TYPE_INVALID) {
+    if (!gy_classes_by_gtype)
+      gy_classes_by_gtype = g_hash_table_new(NULL, NULL);
+    klass = g_hash_table_lookup(gy_classes_by_gtype,
+				GSIZE_TO_POINTER(gtype));
+    if (!klass) {
+      klass = gy_Class_new(info, gtype);
+      g_hash_table_insert(gy_classes_by_gtype,
+			  GSIZE_TO_POINTER(gtype), klass);
+    }
+    return klass;
+  }
+
+  // namespace -> (name -> class). Both strings belong to the typelib,
+  // which is never unloaded.
+  const gchar * nspace = g_base_info_get_namespace(info);
+  const gchar * name   = g_base_info_get_name(info);
+  GHashTable * byname;
+  if (!gy_classes_by_name)
+    gy_classes_by_name = g_hash_table_new(g_str_hash, g_str_equal);
+  byname = g_hash_table_lookup(gy_classes_by_name, nspace);
+  if (!byname) {
+    byname = g_hash_table_new(g_str_hash, g_str_equal);
+    g_hash_table_insert(gy_classes_by_name, (gpointer) nspace, byname);
+  }
+  klass = g_hash_table_lookup(byname, name);
+  if (!klass) {
+    klass = gy_Class_new(info, gtype);
+    g_hash_table_insert(byname, (gpointer) name, klass);
+  }
+  return klass;
+}
+
+/// TYPE INFO CACHE
+
+/*
+  g_irepository_find_by_gtype is costly and returns a new reference at
+  each call. Infos are cached per GType for the whole session. Types
+  unknown to the repository (e.g. private subclasses) resolve to their
+  closest introspectable ancestor.
+
+  The returned info is owned by the cache.
+ */
+
+static GHashTable * gy_infos_by_gtype = NULL;
+
+GIBaseInfo *
+gy_info_from_gtype(GType gtype)
+{
+  GIBaseInfo * info;
+  GType cur;
+
+  if (!gy_infos_by_gtype)
+    gy_infos_by_gtype = g_hash_table_new(NULL, NULL);
+  info = g_hash_table_lookup(gy_infos_by_gtype, GSIZE_TO_POINTER(gtype));
+  if (info) return info;
+
+  for (cur=gtype; cur && !info; cur=g_type_parent(cur))
+    info = g_irepository_find_by_gtype(NULL, cur);
+  if (info)
+    g_hash_table_insert(gy_infos_by_gtype, GSIZE_TO_POINTER(gtype), info);
+  return info;
+}
+
+/* Same for types defined by GLib (GBytes, GVariant...), loading the
+   GLib typelib if needed. */
+GIBaseInfo *
+gy_glib_info(GType gtype)
+{
+  GIBaseInfo * info = gy_info_from_gtype(gtype);
+  GError * err = NULL;
+  if (info) return info;
+  if (!g_irepository_require(NULL, "GLib", NULL, 0, &err)) {
+    GY_DEBUG("%s\n", err->message);
+    g_error_free(err);
+    return NULL;
+  }
+  return gy_info_from_gtype(gtype);
+}
+
+/// METHODS
+
+/* Add the methods declared directly in INFO to TBL, unless a method
+   by the same name is already there (i.e. overridden in a child). */
+static void
+gy_Class_add_methods(GHashTable * tbl, GIBaseInfo * info)
+{
+  gint i, n;
+  GIFunctionInfo * mi;
+  const gchar * name;
+  GIInfoType type = g_base_info_get_type(info);
+
+  switch (type) {
+  case GI_INFO_TYPE_OBJECT:
+    n = g_object_info_get_n_methods(info);
+    break;
+  case GI_INFO_TYPE_INTERFACE:
+    n = g_interface_info_get_n_methods(info);
+    break;
+  case GI_INFO_TYPE_STRUCT:
+    n = g_struct_info_get_n_methods(info);
+    break;
+  default:
+    return;
+  }
+
+  for (i=0; i<n; ++i) {
+    switch (type) {
+    case GI_INFO_TYPE_OBJECT:
+      mi = g_object_info_get_method(info, i);
+      break;
+    case GI_INFO_TYPE_INTERFACE:
+      mi = g_interface_info_get_method(info, i);
+      break;
+    default:
+      mi = g_struct_info_get_method(info, i);
+    }
+    name = g_intern_string(g_base_info_get_name(mi));
+    if (g_hash_table_lookup(tbl, name)) g_base_info_unref(mi);
+    else g_hash_table_insert(tbl, (gpointer) name, mi);
+  }
+}
+
+/* Add the methods of interface ITRF and of the interfaces it
+   requires. */
+static void
+gy_Class_add_interface_methods(GHashTable * tbl, GIInterfaceInfo * itrf)
+{
+  gint i, n;
+  GIBaseInfo * pre;
+
+  gy_Class_add_methods(tbl, itrf);
+  n = g_interface_info_get_n_prerequisites(itrf);
+  for (i=0; i<n; ++i) {
+    pre = g_interface_info_get_prerequisite(itrf, i);
+    if (GI_IS_INTERFACE_INFO(pre)) gy_Class_add_interface_methods(tbl, pre);
+    g_base_info_unref(pre);
+  }
+}
+
+/* Flatten the methods of the class, all its ancestors and all the
+   interfaces they implement. Methods of the class hierarchy take
+   precedence over those of interfaces. */
+static void
+gy_Class_build_methods(gy_Class * klass)
+{
+  GHashTable * tbl = g_hash_table_new(g_str_hash, g_str_equal);
+  GIBaseInfo * cur, * next;
+  gint i, n;
+
+  if (GI_IS_INTERFACE_INFO(klass->info)) {
+    gy_Class_add_interface_methods(tbl, klass->info);
+    klass -> methods = tbl;
+    return;
+  }
+
+  cur = g_base_info_ref(klass->info);
+  while (cur) {
+    gy_Class_add_methods(tbl, cur);
+    next = GI_IS_OBJECT_INFO(cur) ? g_object_info_get_parent(cur) : NULL;
+    g_base_info_unref(cur);
+    cur = next;
+  }
+
+  if (GI_IS_OBJECT_INFO(klass->info)) {
+    cur = g_base_info_ref(klass->info);
+    while (cur) {
+      n = g_object_info_get_n_interfaces(cur);
+      for (i=0; i<n; ++i) {
+	GIInterfaceInfo * itrf = g_object_info_get_interface(cur, i);
+	gy_Class_add_interface_methods(tbl, itrf);
+	g_base_info_unref(itrf);
+      }
+      next = g_object_info_get_parent(cur);
+      g_base_info_unref(cur);
+      cur = next;
+    }
+  }
+
+  GY_DEBUG("%s has %d methods (including inherited)\n",
+	   g_base_info_get_name(klass->info),
+	   g_hash_table_size(tbl));
+  klass -> methods = tbl;
+}
+
+GIFunctionInfo *
+gy_Class_find_method(gy_Class * klass, const char * name)
+{
+  if (!klass->methods) gy_Class_build_methods(klass);
+  return g_hash_table_lookup(klass->methods, name);
+}
+
+/// ENUMS
+
+/*
+  Enum and flags values are looked up case-insensitively (GI names are
+  lower case, but the C documentation spells them in upper case).
+ */
+
+static guint
+gy_ascii_case_hash(gconstpointer key)
+{
+  const gchar * p = key;
+  guint h = 5381;
+  for (; *p; ++p) h = (h << 5) + h + g_ascii_tolower(*p);
+  return h;
+}
+
+static gboolean
+gy_ascii_case_equal(gconstpointer a, gconstpointer b)
+{
+  return !g_ascii_strcasecmp(a, b);
+}
+
+static void
+gy_Class_build_values(gy_Class * klass)
+{
+  GHashTable * tbl = g_hash_table_new(gy_ascii_case_hash, gy_ascii_case_equal);
+  gint i, n = g_enum_info_get_n_values(klass->info);
+  GIValueInfo * vi;
+
+  klass -> values = g_new0(gint64, n);
+  for (i=0; i<n; ++i) {
+    vi = g_enum_info_get_value(klass->info, i);
+    klass -> values[i] = g_value_info_get_value(vi);
+    // the name belongs to the typelib
+    g_hash_table_insert(tbl, (gpointer) g_base_info_get_name(vi),
+			klass->values+i);
+    g_base_info_unref(vi);
+  }
+  klass -> value_names = tbl;
+}
+
+gboolean
+gy_Class_find_value(gy_Class * klass, const char * name, gint64 * value)
+{
+  gint64 * v;
+  if (!klass->value_names) gy_Class_build_values(klass);
+  v = g_hash_table_lookup(klass->value_names, name);
+  if (!v) return FALSE;
+  *value = *v;
+  return TRUE;
+}
+
+/* OR together the values named in STR, separated by '|', ',' or
+   blanks. */
+static gint64
+gy_Class_parse_flags(gy_Class * klass, const char * str)
+{
+  static const char * delim = "| ,\t";
+  gint64 mask = 0, value;
+  char tok[128];
+  size_t len;
+
+  if (!str) return 0;
+  while (*str) {
+    str += strspn(str, delim);
+    if (!*str) break;
+    len = strcspn(str, delim);
+    if (len >= sizeof(tok)) y_error("flag name too long");
+    memcpy(tok, str, len);
+    tok[len] = '\0';
+    if (!gy_Class_find_value(klass, tok, &value))
+      y_errorq("No such enum value: %s", tok);
+    mask |= value;
+    str += len;
+  }
+  return mask;
+}
+
+void
+Y_gy_flags(int argc)
+{
+  if (argc < 2) y_error("gy_flags takes at least 2 arguments");
+  gy_Object * o = yget_gy_Object(argc-1);
+  if (!o->info || !GI_IS_ENUM_INFO(o->info))
+    y_error("first argument must be an enum or flags type");
+  gy_Class * klass = gy_Class_get(o->info);
+  gint64 mask = 0;
+  long ntot, i;
+  int iarg;
+
+  for (iarg=argc-2; iarg>=0; --iarg) {
+    if (yarg_nil(iarg)) continue;
+    if (yarg_string(iarg)) {
+      ystring_t * names = ygeta_q(iarg, &ntot, NULL);
+      for (i=0; i<ntot; ++i) mask |= gy_Class_parse_flags(klass, names[i]);
+    } else {
+      long * values = ygeta_l(iarg, &ntot, NULL);
+      for (i=0; i<ntot; ++i) mask |= values[i];
+    }
+  }
+  ypush_long(mask);
+}
@@ -0,0 +1,571 @@
+/*
+    Copyright 2013 Thibaut Paumard
+
+    This file is part of gy (GObject Introspection for Yorick).
+
+    Gyoto is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gyoto is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gy.h"
+
+/// SCRATCH ARENA
+
+/*
+  Temporaries needed during a call (argument arrays of unusual length,
+  array copies, GValues...) are taken from a bump allocator. Each call
+  opens a scope by pushing a scratch object on the Yorick stack; when
+  it is dropped, either at the end of the call or when the stack is
+  cleaned after an error, the arena is rewound to where the scope
+  started. Scopes nest, since calls may recurse through callbacks.
+
+  Memory allocated outside of any scope is reclaimed when the next
+  outermost scope opens.
+
+  Temporaries holding references (e.g. GValues) register a cleanup
+  with gy_arena_defer, run when their scope is released.
+ */
+
+#define GY_ARENA_CHUNK 65536
+
+typedef struct _gy_Chunk {
+  struct _gy_Chunk * prev;
+  gsize size;
+  gsize used;
+} gy_Chunk;
+
+// keep the data of a chunk suitably aligned
+#define GY_CHUNK_HEADER ((sizeof(gy_Chunk)+15) & ~(gsize)15)
+
+typedef struct _gy_Cleanup {
+  struct _gy_Cleanup * prev;
+  GDestroyNotify func;
+  gpointer data;
+} gy_Cleanup;
+
+typedef struct _gy_ArenaMark {
+  gy_Chunk * chunk;
+  gsize used;
+  gy_Cleanup * cleanup;
+  sigjmp_buf * guard_env; // see CRASH GUARD below
+} gy_ArenaMark;
+
+static gy_Chunk * gy_arena = NULL;
+static gy_Cleanup * gy_arena_cleanup = NULL;
+static gint gy_arena_depth = 0;
+static __thread sigjmp_buf * gy_guard_env = NULL;
+
+gpointer
+gy_arena_alloc(gsize size)
+{
+  gpointer p;
+  size = (size + 15) & ~(gsize)15;
+  if (!gy_arena || gy_arena->used + size > gy_arena->size) {
+    gsize n = size > GY_ARENA_CHUNK ? size : GY_ARENA_CHUNK;
+    gy_Chunk * c = g_malloc(GY_CHUNK_HEADER + n);
+    c -> prev = gy_arena;
+    c -> size = n;
+    c -> used = 0;
+    gy_arena = c;
+  }
+  p = (guint8*)gy_arena + GY_CHUNK_HEADER + gy_arena->used;
+  gy_arena -> used += size;
+  return p;
+}
+
+/* Rewind to MARK, freeing the chunks added since. The first chunk is
+   kept for the next calls. */
+static void
+gy_arena_release(void * mark)
+{
+  gy_ArenaMark * m = mark;
+  gy_Chunk * c;
+  gy_Cleanup * cl;
+  // the records live in the arena: run them before rewinding it
+  while (gy_arena_cleanup && gy_arena_cleanup != m->cleanup) {
+    cl = gy_arena_cleanup;
+    gy_arena_cleanup = cl->prev;
+    cl -> func(cl->data);
+  }
+  while (gy_arena && gy_arena != m->chunk && gy_arena->prev) {
+    c = gy_arena;
+    gy_arena = c->prev;
+    g_free(c);
+  }
+  if (gy_arena) gy_arena->used = (gy_arena == m->chunk) ? m->used : 0;
+  // a Yorick error in a callback may have unwound a guarded call
+  gy_guard_env = m->guard_env;
+  --gy_arena_depth;
+}
+
+/* Call FUNC(DATA) when the current scope is released. */
+void
+gy_arena_defer(GDestroyNotify func, gpointer data)
+{
+  gy_Cleanup * cl = gy_arena_alloc(sizeof(gy_Cleanup));
+  cl -> prev = gy_arena_cleanup;
+  cl -> func = func;
+  cl -> data = data;
+  gy_arena_cleanup = cl;
+}
+
+void
+gy_arena_push_scope(void)
+{
+  gy_ArenaMark * m;
+  if (!gy_arena_depth && gy_arena) {
+    gy_ArenaMark all = {NULL, 0, NULL, NULL};
+    ++gy_arena_depth;
+    gy_arena_release(&all);
+  }
+  m = ypush_scratch(sizeof(gy_ArenaMark), &gy_arena_release);
+  m -> chunk = gy_arena;
+  m -> used  = gy_arena ? gy_arena->used : 0;
+  m -> cleanup = gy_arena_cleanup;
+  m -> guard_env = gy_guard_env;
+  ++gy_arena_depth;
+}
+
+/// CRASH GUARD
+
+/*
+  Foreign calls are protected against SIGSEGV and SIGABRT by handlers
+  installed once and for all. A signal received during a foreign call
+  jumps back to gy_Plan_invoke, which turns it into a Yorick error;
+  other signals are passed on to the handlers previously installed.
+
+  gy_guard selects the protection level:
+   0: none;
+   1: signals are caught and the floating point environment is saved
+      around every call (default): functions without floating point
+      arguments may still compute with them (layout, drawing, signal
+      handlers), and must not run with Yorick's traps enabled;
+   2: same, and the signal mask is restored after a crash;
+  -1: signals are caught, the floating point environment is saved only
+      around functions taking or returning floating point values.
+ */
+
+static long gy_guard_mode = 1;
+static gboolean gy_guard_installed = 0;
+static struct sigaction gy_guard_oldsegv, gy_guard_oldabrt;
+
+static void
+gy_guard_handler(int sig)
+{
+  if (gy_guard_env) siglongjmp(*gy_guard_env, sig);
+  // not ours: restore the previous handler and let it handle SIG
+  sigaction(sig, sig==SIGSEGV ? &gy_guard_oldsegv : &gy_guard_oldabrt, NULL);
+  gy_guard_installed = 0;
+  raise(sig);
+}
+
+static void
+gy_guard_install(void)
+{
+  struct sigaction act;
+  act.sa_handler = &gy_guard_handler;
+  sigemptyset(&act.sa_mask);
+  // we leave the handler with siglongjmp, don't keep SIG blocked
+  act.sa_flags = SA_NODEFER;
+  sigaction(SIGSEGV, &act, &gy_guard_oldsegv);
+  sigaction(SIGABRT, &act, &gy_guard_oldabrt);
+  gy_guard_installed = 1;
+}
+
+void
+Y_gy_guard(int argc)
+{
+  ypush_long(gy_guard_mode);
+  if (argc && !yarg_nil(argc)) gy_guard_mode = ygets_l(argc);
+}
+
+static gboolean
+gy_type_is_fp(GITypeInfo * type)
+{
+  GITypeTag tag = g_type_info_get_tag(type);
+  GITypeInfo * cell;
+  gboolean res;
+  switch (tag) {
+  case GI_TYPE_TAG_FLOAT:
+  case GI_TYPE_TAG_DOUBLE:
+    return 1;
+  case GI_TYPE_TAG_ARRAY:
+    cell = g_type_info_get_param_type(type, 0);
+    res = gy_type_is_fp(cell);
+    g_base_info_unref(cell);
+    return res;
+  default:
+    return 0;
+  }
+}
+
+/// MARSHALERS
+
+/*
+  Fast paths for the most common argument types. Anything else goes
+  through gy_Argument_getany.
+ */
+
+static void
+gy_marshal_boolean(GIArgument * arg, GITypeInfo * info, int iarg)
+{
+  arg->v_boolean=yarg_true(iarg);
+}
+
+static void
+gy_marshal_uint8(GIArgument * arg, GITypeInfo * info, int iarg)
+{
+  arg->v_uint8=(guint8)ygets_l(iarg);
+}
+
+static void
+gy_marshal_int32(GIArgument * arg, GITypeInfo * info, int iarg)
+{
+  arg->v_int32=(gint32)ygets_l(iarg);
+}
+
+static void
+gy_marshal_uint32(GIArgument * arg, GITypeInfo * info, int iarg)
+{
+  arg->v_uint32=(guint32)ygets_l(iarg);
+}
+
+static void
+gy_marshal_int64(GIArgument * arg, GITypeInfo * info, int iarg)
+{
+  arg->v_int64=ygets_l(iarg);
+}
+
+static void
+gy_marshal_double(GIArgument * arg, GITypeInfo * info, int iarg)
+{
+  arg->v_double=ygets_d(iarg);
+}
+
+static void
+gy_marshal_string(GIArgument * arg, GITypeInfo * info, int iarg)
+{
+  arg->v_string=ygets_q(iarg);
+}
+
+static void
+gy_marshal_object(GIArgument * arg, GITypeInfo * info, int iarg)
+{
+  if (yarg_nil(iarg)) arg->v_pointer=NULL;
+  else arg->v_pointer=yget_gy_Object(iarg)->object;
+}
+
+/* Choose the marshaler for TYPE. Enums are dispatched on their storage
+   type, GValue structures are left to gy_Argument_getany. */
+static gy_Marshaler
+gy_marshaler_for(GITypeInfo * type)
+{
+  GITypeTag tag = g_type_info_get_tag(type);
+  GIBaseInfo * itrf;
+  gy_Marshaler marshal = &gy_Argument_getany;
+
+  switch (tag) {
+  case GI_TYPE_TAG_BOOLEAN:
+    return &gy_marshal_boolean;
+  case GI_TYPE_TAG_UINT8:
+    return &gy_marshal_uint8;
+  case GI_TYPE_TAG_INT32:
+    return &gy_marshal_int32;
+  case GI_TYPE_TAG_UINT32:
+    return &gy_marshal_uint32;
+  case GI_TYPE_TAG_DOUBLE:
+    return &gy_marshal_double;
+  case GI_TYPE_TAG_UTF8:
+  case GI_TYPE_TAG_FILENAME:
+    return &gy_marshal_string;
+  case GI_TYPE_TAG_GLIST:
+  case GI_TYPE_TAG_GSLIST:
+    return &gy_marshal_object;
+  case GI_TYPE_TAG_INTERFACE:
+    itrf = g_type_info_get_interface(type);
+    switch (g_base_info_get_type(itrf)) {
+    case GI_INFO_TYPE_CALLBACK:
+    case GI_INFO_TYPE_OBJECT:
+      marshal = &gy_marshal_object;
+      break;
+    case GI_INFO_TYPE_STRUCT:
+      if (!g_type_is_a(g_registered_type_info_get_g_type(itrf), G_TYPE_VALUE))
+	marshal = &gy_marshal_object;
+      break;
+    case GI_INFO_TYPE_ENUM:
+    case GI_INFO_TYPE_FLAGS:
+      switch (g_enum_info_get_storage_type(itrf)) {
+      case GI_TYPE_TAG_INT32:
+	marshal = &gy_marshal_int32;
+	break;
+      case GI_TYPE_TAG_UINT32:
+	marshal = &gy_marshal_uint32;
+	break;
+      case GI_TYPE_TAG_INT64:
+	marshal = &gy_marshal_int64;
+	break;
+      default:
+	break;
+      }
+      break;
+    default:
+      break;
+    }
+    g_base_info_unref(itrf);
+    return marshal;
+  default:
+    return marshal;
+  }
+}
+
+/// CALL PLANS
+
+/*
+  A call plan is built the first time a function is called and kept for
+  the session, keyed by the function's C symbol. It holds the analysed
+  argument list and a libffi invoker, so that subsequent calls only
+  marshal the arguments and call ffi_call.
+ */
+
+static GHashTable * gy_plans = NULL;
+
+/* Value returned by ffi_call: integral types are widened to ffi_arg. */
+typedef union {
+  ffi_arg  v_ulong;
+  ffi_sarg v_long;
+  gint64   v_int64;
+  gfloat   v_float;
+  gdouble  v_double;
+  gpointer v_pointer;
+} gy_ffi_return;
+
+static gy_Plan *
+gy_Plan_new(GIFunctionInfo * info)
+{
+  gy_Plan * plan = g_new0(gy_Plan, 1);
+  GIFunctionInfoFlags flags = g_function_info_get_flags(info);
+  GIArgInfo arginfo;
+  GIBaseInfo * itrf;
+  GError * err = NULL;
+  gint i;
+
+  plan -> info = g_base_info_ref(info);
+  plan -> is_method = (flags & GI_FUNCTION_IS_METHOD) != 0;
+  plan -> throws = (flags & GI_FUNCTION_THROWS) != 0;
+  plan -> n_args = g_callable_info_get_n_args(info);
+  plan -> slots = g_new0(gy_Slot, plan->n_args);
+  plan -> n_in = plan->is_method;
+
+  for (i=0; i<plan->n_args; ++i) {
+    gy_Slot * slot = plan->slots+i;
+    g_callable_info_load_arg(info, i, &arginfo);
+    slot -> type = g_arg_info_get_type(&arginfo);
+    slot -> direction = g_arg_info_get_direction(&arginfo);
+    slot -> transfer = g_arg_info_get_ownership_transfer(&arginfo);
+    slot -> marshal = gy_marshaler_for(slot->type);
+    slot -> length = -1;
+    if (g_type_info_get_tag(slot->type) == GI_TYPE_TAG_ARRAY &&
+	(slot->length = g_type_info_get_array_length(slot->type)) >= 0)
+      plan->slots[slot->length].is_length = TRUE;
+    if (gy_type_is_fp(slot->type)) plan->uses_fp = 1;
+    if (slot->direction != GI_DIRECTION_OUT) ++plan->n_in;
+    if (slot->direction != GI_DIRECTION_IN) ++plan->n_out;
+    if (slot->direction == GI_DIRECTION_OUT) {
+      ++plan->n_out_only;
+      if (g_arg_info_is_caller_allocates(&arginfo) &&
+	  g_type_info_get_tag(slot->type) == GI_TYPE_TAG_INTERFACE) {
+	itrf = g_type_info_get_interface(slot->type);
+	slot -> gtype = g_registered_type_info_get_g_type(itrf);
+	if (GI_IS_STRUCT_INFO(itrf))
+	  slot -> size = g_struct_info_get_size(itrf);
+	else if (GI_IS_UNION_INFO(itrf))
+	  slot -> size = g_union_info_get_size(itrf);
+	slot -> caller_allocates = slot->size > 0;
+	g_base_info_unref(itrf);
+      }
+    }
+  }
+
+  plan -> rettype = g_callable_info_get_return_type(info);
+  plan -> rettag  = g_type_info_get_tag(plan->rettype);
+  plan -> rettransfer = g_callable_info_get_caller_owns(info);
+  plan -> retlength = -1;
+  if (plan->rettag == GI_TYPE_TAG_ARRAY &&
+      (plan->retlength = g_type_info_get_array_length(plan->rettype)) >= 0)
+    plan->slots[plan->retlength].is_length = TRUE;
+
+  for (i=0; i<plan->n_args; ++i) {
+    if (plan->slots[i].is_length) ++plan->n_length;
+    else if (plan->slots[i].direction == GI_DIRECTION_OUT) ++plan->n_out_plain;
+  }
+  if (gy_type_is_fp(plan->rettype)) plan->uses_fp = 1;
+  if (plan->rettag == GI_TYPE_TAG_INTERFACE) {
+    itrf = g_type_info_get_interface(plan->rettype);
+    if (GI_IS_ENUM_INFO(itrf))
+      plan -> rettag = g_enum_info_get_storage_type(itrf);
+    g_base_info_unref(itrf);
+  }
+
+  plan -> prepped = g_function_info_prep_invoker(info, &plan->invoker, &err);
+  if (!plan->prepped) {
+    GY_DEBUG("Could not prepare invoker for %s: %s\n",
+	     g_function_info_get_symbol(info), err->message);
+    g_error_free(err);
+  }
+
+  GY_DEBUG("New call plan for %s: %d in, %d out\n",
+	   g_function_info_get_symbol(info), plan->n_in, plan->n_out);
+  return plan;
+}
+
+gy_Plan *
+gy_Plan_get(GIFunctionInfo * info)
+{
+  const gchar * symbol = g_function_info_get_symbol(info);
+  gy_Plan * plan;
+  if (!gy_plans) gy_plans = g_hash_table_new(g_str_hash, g_str_equal);
+  plan = g_hash_table_lookup(gy_plans, symbol);
+  if (!plan) {
+    plan = gy_Plan_new(info);
+    // the symbol belongs to the typelib
+    g_hash_table_insert(gy_plans, (gpointer) symbol, plan);
+  }
+  return plan;
+}
+
+/* Narrow the value returned by ffi_call into RETVAL. */
+static void
+gy_Plan_return(gy_Plan * plan, gy_ffi_return * ffi_ret, GIArgument * retval)
+{
+  switch (plan->rettag) {
+  case GI_TYPE_TAG_BOOLEAN:
+    retval->v_boolean = (gboolean) ffi_ret->v_long;
+    break;
+  case GI_TYPE_TAG_INT8:
+    retval->v_int8 = (gint8) ffi_ret->v_long;
+    break;
+  case GI_TYPE_TAG_UINT8:
+    retval->v_uint8 = (guint8) ffi_ret->v_ulong;
+    break;
+  case GI_TYPE_TAG_INT16:
+    retval->v_int16 = (gint16) ffi_ret->v_long;
+    break;
+  case GI_TYPE_TAG_UINT16:
+    retval->v_uint16 = (guint16) ffi_ret->v_ulong;
+    break;
+  case GI_TYPE_TAG_INT32:
+    retval->v_int32 = (gint32) ffi_ret->v_long;
+    break;
+  case GI_TYPE_TAG_UINT32:
+  case GI_TYPE_TAG_UNICHAR:
+    retval->v_uint32 = (guint32) ffi_ret->v_ulong;
+    break;
+  case GI_TYPE_TAG_INT64:
+  case GI_TYPE_TAG_UINT64:
+    retval->v_int64 = ffi_ret->v_int64;
+    break;
+  case GI_TYPE_TAG_FLOAT:
+    retval->v_float = ffi_ret->v_float;
+    break;
+  case GI_TYPE_TAG_DOUBLE:
+    retval->v_double = ffi_ret->v_double;
+    break;
+  case GI_TYPE_TAG_GTYPE:
+    retval->v_size = (gsize) ffi_ret->v_ulong;
+    break;
+  default:
+    retval->v_pointer = ffi_ret->v_pointer;
+  }
+}
+
+/* Call the function, without guard. */
+static gboolean
+gy_Plan_invoke_unguarded(gy_Plan * plan,
+			 GIArgument * in_args, GIArgument * out_args,
+			 GIArgument * retval, GError ** err)
+{
+  if (!plan->prepped)
+    return g_function_info_invoke(plan->info,
+				  in_args, plan->n_in,
+				  out_args, plan->n_out,
+				  retval, err);
+
+  // Same layout as g_function_info_invoke: pointers to the arguments,
+  // instance first, GError** last.
+  gint n = plan->is_method + plan->n_args + plan->throws;
+  gpointer * args = g_newa(gpointer, n);
+  gint i, k = 0, n_in = 0, n_out = 0;
+  GError * local_err = NULL;
+  gpointer err_addr = &local_err;
+  gy_ffi_return ffi_ret;
+
+  if (plan->is_method) args[k++] = in_args + n_in++;
+  for (i=0; i<plan->n_args; ++i) {
+    switch (plan->slots[i].direction) {
+    case GI_DIRECTION_IN:
+      args[k++] = in_args + n_in++;
+      break;
+    case GI_DIRECTION_OUT:
+      args[k++] = out_args + n_out++;
+      break;
+    case GI_DIRECTION_INOUT:
+      args[k++] = in_args + n_in++;
+      ++n_out;
+      break;
+    }
+  }
+  if (plan->throws) args[k++] = &err_addr;
+
+  ffi_call(&plan->invoker.cif, FFI_FN(plan->invoker.native_address),
+	   &ffi_ret, args);
+
+  if (local_err) {
+    g_propagate_error(err, local_err);
+    return FALSE;
+  }
+  gy_Plan_return(plan, &ffi_ret, retval);
+  return TRUE;
+}
+
+gboolean
+gy_Plan_invoke(gy_Plan * plan, GIArgument * in_args, GIArgument * out_args,
+	       GIArgument * retval, GError ** err)
+{
+  long mode = gy_guard_mode;
+  gboolean fp = mode > 0 || plan->uses_fp;
+  sigjmp_buf env, * prev = gy_guard_env;
+  fenv_t fenv;
+  gboolean success;
+  int sig;
+
+  if (!mode)
+    return gy_Plan_invoke_unguarded(plan, in_args, out_args, retval, err);
+
+  if (fp && feholdexcept(&fenv)) y_error("fenv error");
+  if (!gy_guard_installed) gy_guard_install();
+
+  if ((sig = sigsetjmp(env, mode > 1))) {
+    gy_guard_env = prev;
+    if (fp) fesetenv(&fenv);
+    y_errorq("gy action received signal %s",
+	     sig==SIGSEGV ? "SIGSEGV" : sig==SIGABRT ? "SIGABRT" :
+	     "(signal name unknown)");
+  }
+  gy_guard_env = &env;
+
+  success = gy_Plan_invoke_unguarded(plan, in_args, out_args, retval, err);
+
+  gy_guard_env = prev;
+  if (fp) fesetenv(&fenv);
+  return success;
+}
@@ -113,8 +113,7 @@ __gyterm_max=0;
 func __gyterm_key_pressed(widget, event, udata) {
   extern __gyterm_history, __gyterm_cur, __gyterm_max, __gyterm_idx;
 
-  ev = Gdk.EventKey(event);
-  ev, keyval, keyval;
+  event, keyval, keyval;
   if (keyval==Gdk.KEY_Up) {
     if (__gyterm_idx==__gyterm_cur) {
       __gyterm_history(__gyterm_cur)=widget.get_text();
@@ -256,9 +255,7 @@ func gy_gtk_idler_maybe_stop
 
   tlvs = Gtk.Window.list_toplevels();
   res = 0;
-  if (tlvs.size) {
-    for (;!is_void(tlvs);tlvs=tlvs.next) res |= tlvs.data.visible();
-  }
+  if (tlvs.size) res = anyof(gy_map(tlvs, "visible"));
   if (!res) {
     after_error=[];
     gy_gtk_idler, 0;
@@ -414,8 +411,7 @@ if (!is_func(gistct)) {
 
 func __gycmap_callback(widget, event, udata) {
   extern __gycmap_cur_names;
-  ev = Gdk.EventButton(event);
-  ev, x, x, y, y;
+  event, x, x, y, y;
   name= __gycmap_cur_names(long(y/19)+1);
   if (is_void(__gycmap.callback))
     __gycmap_cmd, __gycmap_cur_names(long(y/19)+1);
@@ -581,10 +577,51 @@ func gy_gtk_ywindow_reinit(yid, dpi=, style=)
   window, cur.yid, parent=cur.xid, ypos=-24, dpi=cur.dpi,
     width=long(8.5*cur.dpi), height=long(11*cur.dpi), style=cur.style;
   noop, cur.da.set_size_request(long(8.5*dpi),long(11*dpi));
+  gy_gtk_readout, cur.da, cur.slabel, cur.xlabel, cur.ylabel, cur.dpi;
+}
+
+func __gywindow_readout_limits(cur)
+/* DOCUMENT __gywindow_readout_limits, cur
+     Refresh the viewport and limits cached by the mouse readout of
+     gywindow CUR, which must be the current window. They are also
+     kept in CUR.vp and CUR.lm.
+   SEE ALSO: gy_gtk_readout_limits
+ */
+{
+  save, cur, vp=viewport(), lm=limits();
+  gy_gtk_readout_limits, cur.da, cur.vp, cur.lm,
+    cur.hadjustment, cur.vadjustment;
+}
+
+func __gywindow_refresh(cur)
+/* DOCUMENT __gywindow_refresh, cur
+     Refresh the mouse readout of gywindow CUR, leaving the current
+     window unchanged. Yorick cannot go back to having no current
+     window: in that case the limits seen last are used, if any.
+     Returns 0 if the readout has no limits.
+   SEE ALSO: __gywindow_readout_limits
+ */
+{
+  curwin = current_window();
+  if (curwin<0) {
+    if (is_void(cur.lm)) return 0;
+    gy_gtk_readout_limits, cur.da, cur.vp, cur.lm,
+      cur.hadjustment, cur.vadjustment;
+    return 1;
+  }
+  if (curwin==cur.yid) {
+    __gywindow_readout_limits, cur;
+    return 1;
+  }
+  window, cur.yid;
+  __gywindow_readout_limits, cur;
+  window, curwin;
+  return 1;
 }
 
 func __gywindow_event_handler(widget, event, udata) {
   extern __gywindow, __gywindow_xs0, __gywindow_ys0, __gywindow_device;
+  extern __gywindow_grabbed;
   local curwin, win;
   
   cur = __gywindow_find_by_xid(gy_gtk_xid(widget));
@@ -623,8 +660,6 @@ func __gywindow_event_handler(widget, event, udata) {
 
   if (!cur.grab) return;
 
-  pix2ndc=72.27/cur.dpi*0.0013;
-  
   if (type == EventType.enter_notify && __gy_gtk_allowgrab) {
     __gywindow_device = Gdk.Device(Gtk.get_current_event_device());
     noop, Gtk.Widget(widget)(window, win);
@@ -632,6 +667,9 @@ func __gywindow_event_handler(widget, event, udata) {
                                  Gdk.EventMask.all_events_mask,
                                  ,
                                  Gdk.CURRENT_TIME);
+    // from now on, motion is handled by the compiled readout
+    __gywindow_grabbed = cur;
+    __gywindow_refresh, cur;
     return;
   }
 
@@ -643,9 +681,6 @@ func __gywindow_event_handler(widget, event, udata) {
   if (type == EventType.button_release ||
       type == EventType.button_press ||
       type == EventType.motion_notify) {
-    curwin = current_window();
-    window, cur.yid;
-    
     ev = Gdk.EventButton(ev);
     ev, x, x, y, y, button, button, state, state;
 
@@ -653,34 +688,11 @@ func __gywindow_event_handler(widget, event, udata) {
     meta = state & Gdk.ModifierType.mod1_mask;
     if (shft && !meta && button==1) button=2;
     if (meta && !shft && button==1) button=3;
-        
-    xndc=pix2ndc*(x-2);
-    yndc=11.*72.27*0.0013-pix2ndc*(y-1);
-
-    vp = viewport();
-    lm = limits();
-
-    flags=long(lm(5));
-    xlog = flags & 128;
-    ylog = flags & 256;
-
-    if (xndc < vp(1)) xs = lm(1);
-    else if (xndc>vp(2)) xs=lm(2);
-    else {
-      if (xlog)
-        xs = lm(1) * (lm(2)/lm(1))^((xndc-vp(1))/(vp(2)-vp(1)));
-      else
-        xs = lm(1)+(xndc-vp(1))*(lm(2)-lm(1))/(vp(2)-vp(1));
-    }
 
-    if (yndc < vp(3)) ys = lm(3);
-    else if (yndc>vp(4)) ys=lm(4);
-    else {
-      if (xlog)
-        ys = lm(3) * (lm(4)/lm(3))^((yndc-vp(3))/(vp(4)-vp(3)));
-      else
-        ys = lm(3)+(yndc-vp(3))*(lm(4)-lm(3))/(vp(4)-vp(3));
-    }
+    if (!__gywindow_refresh(cur)) return;
+    xy = gy_gtk_readout_coords(cur.da, x, y);
+    xs = xy(1);
+    ys = xy(2);
   }
 
   if (type == EventType.button_press) {
@@ -689,49 +701,29 @@ func __gywindow_event_handler(widget, event, udata) {
   }
 
   if (type == EventType.button_release) {
-
-    lm = limits();
-    flags=long(lm(5));
-
+    // the handler and the zoom act on the window: select it. With no
+    // current window before, it stays current as after a plot.
+    curwin = current_window();
+    window, cur.yid;
     if (is_func(cur.mouse_handler)) {
       noop, cur.mouse_handler(cur.yid,
                               __gywindow_xs0, __gywindow_ys0,
-                              xs, ys, button, flags);
-      if (!is_void(curwin) && curwin>=0) window, curwin;
-      return;
+                              xs, ys, button, long(limits()(5)));
+      // the handler may have selected another window
+      window, cur.yid;
+    } else {
+      lm2 = gy_gtk_readout_zoom(cur.da, __gywindow_xs0, __gywindow_ys0,
+                                xs, ys, button);
+      if (lm2(5)) limits, lm2(1), lm2(2);
+      if (lm2(6)) range, lm2(3), lm2(4);
     }
-
-    lm2=lm;
-    fact=1.;
-    if (button==1) fact=2./3.;
-    else if (button==3) fact=1.5;
-
-    xlog = flags & 128;
-    ylog = flags & 256;
-
-    if (noneof(__gywindow_xs0 == lm(1:2))) {
-      if (xlog) {
-        lm2(1:2)=__gywindow_xs0 / (xs/lm(1:2))^fact;
-      } else {
-        lm2(1:2)=__gywindow_xs0 - (xs-lm(1:2))*fact;
-      }
-      limits, lm2(1), lm2(2);
-    }
-
-    if (noneof(__gywindow_ys0 == lm(3:4))) {
-      if (ylog) {
-        lm2(3:4)=__gywindow_ys0 / (ys/lm(3:4))^fact;
-      } else {
-        lm2(3:4)=__gywindow_ys0 - (ys-lm(3:4))*fact;
-      }
-      range, lm2(3), lm2(4);
-    }
-    
+    __gywindow_readout_limits, cur;
+    if (curwin>=0) window, curwin;
+    return;
   }
 
-  if (!is_void(curwin) && curwin>=0) window, curwin;
-  
   if (type == EventType.motion_notify) {
+    // the compiled readout passes on motion outside the visible area
     if (x<cur.hadjustment.get_value() ||
         y<cur.vadjustment.get_value() ||
         x>cur.hadjustment.get_value()+cur.hadjustment.get_page_size() ||
@@ -739,9 +731,7 @@ func __gywindow_event_handler(widget, event, udata) {
       __gywindow_ungrab;
       return;
     }
-    noop, cur.slabel.set_text("?");
-    noop, cur.xlabel.set_text(swrite(xs));
-    noop, cur.ylabel.set_text(swrite(ys));
+    gy_gtk_readout_show, cur.da, xs, ys, "?";
     return;
   }
   
@@ -782,9 +772,11 @@ func gy_gtk_ywindow_connect(&yid, win, da, slabel, xlabel, ylabel, dpi=, style=,
   if (is_void(yid)) error, "unable to find free id";
   
   if (is_void(dpi)) dpi=75;
+  // the compiled readout must see events first
+  gy_gtk_readout, da, slabel, xlabel, ylabel, dpi;
   gy_signal_connect, da, "event", __gywindow_event_handler;
   save, __gywindow, "", save(yid, xid=[], win, da, slabel, xlabel, ylabel,
-                             realized=0, dpi, style,
+                             realized=0, dpi, style, vp=[], lm=[],
                              mouse_handler=[],
                              on_realize, on_configure, grab);
 }
@@ -1438,13 +1430,13 @@ func gy_gtk_idler (start_stop)
   // process Gtk events
   gy_gtk_idler_flush;
 
-  // read mouse to update non-grabing gywindows
-  if (!is_void( (psn=current_mouse()) )  &&
-      !is_void( (cur=__gywindow_find_by_yid(psn(0))) )) {
-    noop, cur.slabel.set_text(swrite(long(psn(3))));
-    noop, cur.xlabel.set_text(swrite(psn(1)));
-    noop, cur.ylabel.set_text(swrite(psn(2)));
-  }
+  // read mouse to update non-grabing gywindows; a grabbing one is
+  // handled by the compiled readout, its limits being refreshed on
+  // button events and when the pointer enters it
+  if (is_void(__gywindow_grabbed) &&
+      !is_void( (psn=current_mouse()) )  &&
+      !is_void( (cur=__gywindow_find_by_yid(psn(0))) ))
+    gy_gtk_readout_show, cur.da, psn(1), psn(2), long(psn(3));
 
   // start idler
   after, gy_gtk_idler_period, gy_gtk_idler;
@@ -1479,7 +1471,9 @@ func gy_gtk_idler_flush
 
 func __gywindow_ungrab
 {
-  extern __gywindow_device;
+  extern __gywindow_device, __gywindow_grabbed;
   if (!is_void(__gywindow_device)) noop, __gywindow_device.ungrab(Gdk.CURRENT_TIME);
   __gywindow_device = [];
+  if (!is_void(__gywindow_grabbed)) gy_gtk_readout_limits, __gywindow_grabbed.da;
+  __gywindow_grabbed = [];
 }
@@ -43,7 +43,7 @@ gy_value_init(GValue * val, GITypeInfo * info)
     break;
   case GI_TYPE_TAG_UINT16:
   case GI_TYPE_TAG_UINT32:
-    g_value_init(val, G_TYPE_INT);
+    g_value_init(val, G_TYPE_UINT);
     break;
   case GI_TYPE_TAG_INT64:
     g_value_init(val, G_TYPE_INT64);
@@ -209,9 +209,15 @@ gy_value_push(GValue * pval, GITypeInfo * info, gy_Object* o)
     *ypush_q(NULL) = p_strcpy(g_value_get_string(pval));
     break;
     /* array types */
-  case GI_TYPE_TAG_ARRAY:
-    y_error("array");
+  case GI_TYPE_TAG_ARRAY: {
+    // GStrv and array boxes
+    GIArgument arg;
+    arg.v_pointer = g_value_get_boxed(pval);
+    long len = gy_Argument_array_length(&arg, info);
+    if (len < 0) y_error("array of unknown length");
+    gy_Argument_pusharray(&arg, info, len, GI_TRANSFER_NOTHING);
     break;
+  }
     /* interface types */
   case GI_TYPE_TAG_INTERFACE:
     {
@@ -250,3 +256,552 @@ gy_value_push(GValue * pval, GITypeInfo * info, gy_Object* o)
 
 
 }
+
+/// CONVERTERS
+
+/*
+  Converters between GValues and Yorick values, keyed by GType. The
+  converter of a type is found once, walking up to its fundamental
+  type if needed (enums, flags, objects, boxed types), and cached both
+  here and in the gy_Property records, so that getting or setting a
+  property is a direct call.
+
+  Boxed structures made only of fields of one numeric type (e.g.
+  GdkRGBA, four doubles) get their own converter, which also accepts
+  a Yorick array holding the fields in order.
+ */
+
+static GHashTable * gy_value_convs = NULL;
+
+static void
+gy_value_set_boolean(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_boolean(val, yarg_true(iarg));
+}
+
+static void
+gy_value_push_boolean(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  *ypush_c(NULL) = g_value_get_boolean(val);
+}
+
+static void
+gy_value_set_char(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_schar(val, ygets_c(iarg));
+}
+
+static void
+gy_value_push_char(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  *ypush_gint8(NULL) = g_value_get_schar(val);
+}
+
+static void
+gy_value_set_uchar(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_uchar(val, ygets_c(iarg));
+}
+
+static void
+gy_value_push_uchar(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  *ypush_guint8(NULL) = g_value_get_uchar(val);
+}
+
+static void
+gy_value_set_int(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_int(val, ygets_i(iarg));
+}
+
+static void
+gy_value_push_int(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  *ypush_gint32(NULL) = g_value_get_int(val);
+}
+
+static void
+gy_value_set_uint(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_uint(val, ygets_l(iarg));
+}
+
+static void
+gy_value_push_uint(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long(g_value_get_uint(val));
+}
+
+static void
+gy_value_set_long(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_long(val, ygets_l(iarg));
+}
+
+static void
+gy_value_push_long(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long(g_value_get_long(val));
+}
+
+static void
+gy_value_set_ulong(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_ulong(val, ygets_l(iarg));
+}
+
+static void
+gy_value_push_ulong(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long(g_value_get_ulong(val));
+}
+
+static void
+gy_value_set_int64(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_int64(val, ygets_l(iarg));
+}
+
+static void
+gy_value_push_int64(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long(g_value_get_int64(val));
+}
+
+static void
+gy_value_set_uint64(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_uint64(val, ygets_l(iarg));
+}
+
+static void
+gy_value_push_uint64(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long(g_value_get_uint64(val));
+}
+
+static void
+gy_value_set_float(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_float(val, ygets_f(iarg));
+}
+
+static void
+gy_value_push_float(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  *ypush_f(NULL) = g_value_get_float(val);
+}
+
+static void
+gy_value_set_double(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_double(val, ygets_d(iarg));
+}
+
+static void
+gy_value_push_double(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_double(g_value_get_double(val));
+}
+
+static void
+gy_value_set_gtype(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_gtype(val, ygets_l(iarg));
+}
+
+static void
+gy_value_push_gtype(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long(g_value_get_gtype(val));
+}
+
+static void
+gy_value_set_string(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_string(val, yarg_nil(iarg) ? NULL : ygets_q(iarg));
+}
+
+static void
+gy_value_push_string(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  *ypush_q(NULL) = p_strcpy(g_value_get_string(val));
+}
+
+/* enum values may be given by name or nick */
+static void
+gy_value_set_enum(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  if (yarg_string(iarg)) {
+    const char * name = ygets_q(iarg);
+    GEnumClass * klass = g_type_class_ref(G_VALUE_TYPE(val));
+    GEnumValue * ev = g_enum_get_value_by_nick(klass, name);
+    if (!ev) ev = g_enum_get_value_by_name(klass, name);
+    g_type_class_unref(klass);
+    if (!ev) y_errorq("No such enum value: %s", name);
+    g_value_set_enum(val, ev->value);
+  } else g_value_set_enum(val, ygets_l(iarg));
+}
+
+static void
+gy_value_push_enum(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long(g_value_get_enum(val));
+}
+
+static void
+gy_value_set_flags(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_flags(val, ygets_l(iarg));
+}
+
+static void
+gy_value_push_flags(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long(g_value_get_flags(val));
+}
+
+static void
+gy_value_set_object(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_object(val,
+		     yarg_nil(iarg) ? NULL : yget_gy_Object(iarg)->object);
+}
+
+static void
+gy_value_push_object(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  GObject * obj = g_value_get_object(val);
+  if (!obj) {
+    ypush_nil();
+    return;
+  }
+  gy_Object * out = ypush_gy_Object();
+  // the actual type is resolved by gy_Object_resolve if needed
+  out -> object = g_object_ref(obj);
+  out -> lazy = TRUE;
+  out -> repo = o ? o->repo : NULL;
+}
+
+static void
+gy_value_set_pointer(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_pointer(val,
+		      yarg_nil(iarg) ? NULL : (gpointer) ygets_l(iarg));
+}
+
+static void
+gy_value_push_pointer(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  ypush_long((long) g_value_get_pointer(val));
+}
+
+static void
+gy_value_set_variant(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  g_value_set_variant(val,
+		      yarg_nil(iarg) ? NULL : gy_variant_get(iarg, NULL));
+}
+
+static void
+gy_value_push_variant(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  GVariant * v = g_value_get_variant(val);
+  if (v) gy_variant_push(v);
+  else ypush_nil();
+}
+
+static void
+gy_value_set_strv(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  long ntot, i;
+  if (yarg_nil(iarg)) {
+    g_value_set_boxed(val, NULL);
+    return;
+  }
+  ystring_t * str = ygeta_q(iarg, &ntot, NULL);
+  gchar ** strv = g_new0(gchar*, ntot+1);
+  for (i=0; i<ntot; ++i) strv[i] = g_strdup(str[i] ? str[i] : "");
+  g_value_take_boxed(val, strv);
+}
+
+static void
+gy_value_push_strv(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  gchar ** strv = g_value_get_boxed(val);
+  long n = strv ? g_strv_length(strv) : 0, i;
+  if (!n) {
+    ypush_nil();
+    return;
+  }
+  long dims[Y_DIMSIZE] = {1, n};
+  ystring_t * res = ypush_q(dims);
+  for (i=0; i<n; ++i) res[i] = p_strcpy(strv[i]);
+}
+
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+
+/* numeric arrays give arrays of long or double, string arrays arrays
+   of strings */
+static void
+gy_value_set_value_array(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  long ntot, i;
+  GValueArray * arr;
+  GValue cell = G_VALUE_INIT;
+
+  if (yarg_nil(iarg)) {
+    g_value_set_boxed(val, NULL);
+    return;
+  }
+  if (yarg_string(iarg)) {
+    ystring_t * q = ygeta_q(iarg, &ntot, NULL);
+    arr = g_value_array_new(ntot);
+    g_value_init(&cell, G_TYPE_STRING);
+    for (i=0; i<ntot; ++i) {
+      g_value_set_string(&cell, q[i]);
+      g_value_array_append(arr, &cell);
+    }
+  } else if (yarg_number(iarg) == 1) {
+    long * l = ygeta_l(iarg, &ntot, NULL);
+    arr = g_value_array_new(ntot);
+    g_value_init(&cell, G_TYPE_LONG);
+    for (i=0; i<ntot; ++i) {
+      g_value_set_long(&cell, l[i]);
+      g_value_array_append(arr, &cell);
+    }
+  } else {
+    double * d = ygeta_d(iarg, &ntot, NULL);
+    arr = g_value_array_new(ntot);
+    g_value_init(&cell, G_TYPE_DOUBLE);
+    for (i=0; i<ntot; ++i) {
+      g_value_set_double(&cell, d[i]);
+      g_value_array_append(arr, &cell);
+    }
+  }
+  g_value_unset(&cell);
+  g_value_take_boxed(val, arr);
+}
+
+/* arrays of numbers or strings, all of the same type */
+static void
+gy_value_push_value_array(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  GValueArray * arr = g_value_get_boxed(val);
+  long n = arr ? arr->n_values : 0, i;
+  GValue tmp = G_VALUE_INIT;
+  if (!n) {
+    ypush_nil();
+    return;
+  }
+  long dims[Y_DIMSIZE] = {1, n};
+  GType t = G_VALUE_TYPE(arr->values);
+  for (i=1; i<n; ++i)
+    if (G_VALUE_TYPE(arr->values+i) != t)
+      y_error("GValueArray with values of different types");
+  if (t == G_TYPE_STRING) {
+    ystring_t * res = ypush_q(dims);
+    for (i=0; i<n; ++i) res[i] = p_strcpy(g_value_get_string(arr->values+i));
+  } else if (t == G_TYPE_FLOAT || t == G_TYPE_DOUBLE) {
+    double * res = ypush_d(dims);
+    g_value_init(&tmp, G_TYPE_DOUBLE);
+    for (i=0; i<n; ++i) {
+      g_value_transform(arr->values+i, &tmp);
+      res[i] = g_value_get_double(&tmp);
+    }
+  } else if (g_value_type_transformable(t, G_TYPE_LONG)) {
+    long * res = ypush_l(dims);
+    g_value_init(&tmp, G_TYPE_LONG);
+    for (i=0; i<n; ++i) {
+      g_value_transform(arr->values+i, &tmp);
+      res[i] = g_value_get_long(&tmp);
+    }
+  } else y_errorq("Unimplemented GValueArray element type: %s",
+		  g_type_name(t));
+  if (G_IS_VALUE(&tmp)) g_value_unset(&tmp);
+}
+
+G_GNUC_END_IGNORE_DEPRECATIONS
+
+static void
+gy_value_set_bytes(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  if (yarg_nil(iarg)) g_value_set_boxed(val, NULL);
+  else if (yarg_gy_Object(iarg))
+    g_value_set_boxed(val, yget_gy_Object(iarg)->object);
+  else g_value_take_boxed(val, gy_bytes_get(iarg));
+}
+
+static void
+gy_value_push_bytes(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  gy_bytes_push(g_value_get_boxed(val));
+}
+
+/* other boxed values: a copy owned by the Yorick object */
+static void
+gy_value_set_boxed(const gy_ValueConv * c, GValue * val, int iarg)
+{
+  long ntot, i;
+  if (yarg_nil(iarg)) {
+    g_value_set_boxed(val, NULL);
+    return;
+  }
+  if (yarg_gy_Object(iarg) || !c->n_cells) {
+    gy_Object * o = yget_gy_Object(iarg);
+    GType t = o->boxed;
+    // the copy function of the value type is applied to the object
+    if (!t && o->info && GI_IS_REGISTERED_TYPE_INFO(o->info))
+      t = g_registered_type_info_get_g_type(o->info);
+    if (!t || !g_type_is_a(t, G_VALUE_TYPE(val)))
+      y_errorq("expecting a %s", g_type_name(G_VALUE_TYPE(val)));
+    g_value_set_boxed(val, o->object);
+    return;
+  }
+  // flat structure given as an array of its fields
+  double * d = ygeta_d(iarg, &ntot, NULL);
+  if (ntot != c->n_cells)
+    y_errorn("expecting an array of %ld values", c->n_cells);
+  gpointer mem = gy_arena_alloc(c->struct_size);
+  memset(mem, 0, c->struct_size);
+  for (i=0; i<ntot; ++i) {
+    switch (c->cell_tag) {
+    case GI_TYPE_TAG_DOUBLE: ((gdouble*)mem)[i] = d[i]; break;
+    case GI_TYPE_TAG_FLOAT:  ((gfloat*)mem)[i]  = d[i]; break;
+    case GI_TYPE_TAG_INT32:  ((gint32*)mem)[i]  = d[i]; break;
+    case GI_TYPE_TAG_UINT32: ((guint32*)mem)[i] = d[i]; break;
+    case GI_TYPE_TAG_INT16:  ((gint16*)mem)[i]  = d[i]; break;
+    case GI_TYPE_TAG_UINT16: ((guint16*)mem)[i] = d[i]; break;
+    default:                 ((guint8*)mem)[i]  = d[i];
+    }
+  }
+  // copied by GObject
+  g_value_set_boxed(val, mem);
+}
+
+static void
+gy_value_push_boxed(const gy_ValueConv * c, GValue * val, gy_Object * o)
+{
+  gpointer boxed = g_value_get_boxed(val);
+  if (!boxed) {
+    ypush_nil();
+    return;
+  }
+  GIBaseInfo * info = gy_info_from_gtype(G_VALUE_TYPE(val));
+  gy_Object * out = ypush_gy_Object();
+  out -> object = g_value_dup_boxed(val);
+  out -> boxed = G_VALUE_TYPE(val);
+  out -> repo = o ? o->repo : NULL;
+  if (info) out -> info = g_base_info_ref(info);
+}
+
+static const gy_ValueConv gy_value_basic_convs[] = {
+  {G_TYPE_BOOLEAN, gy_value_set_boolean, gy_value_push_boolean},
+  {G_TYPE_CHAR,    gy_value_set_char,    gy_value_push_char},
+  {G_TYPE_UCHAR,   gy_value_set_uchar,   gy_value_push_uchar},
+  {G_TYPE_INT,     gy_value_set_int,     gy_value_push_int},
+  {G_TYPE_UINT,    gy_value_set_uint,    gy_value_push_uint},
+  {G_TYPE_LONG,    gy_value_set_long,    gy_value_push_long},
+  {G_TYPE_ULONG,   gy_value_set_ulong,   gy_value_push_ulong},
+  {G_TYPE_INT64,   gy_value_set_int64,   gy_value_push_int64},
+  {G_TYPE_UINT64,  gy_value_set_uint64,  gy_value_push_uint64},
+  {G_TYPE_FLOAT,   gy_value_set_float,   gy_value_push_float},
+  {G_TYPE_DOUBLE,  gy_value_set_double,  gy_value_push_double},
+  {G_TYPE_STRING,  gy_value_set_string,  gy_value_push_string},
+  {G_TYPE_ENUM,    gy_value_set_enum,    gy_value_push_enum},
+  {G_TYPE_FLAGS,   gy_value_set_flags,   gy_value_push_flags},
+  {G_TYPE_OBJECT,  gy_value_set_object,  gy_value_push_object},
+  {G_TYPE_INTERFACE, gy_value_set_object, gy_value_push_object},
+  {G_TYPE_POINTER, gy_value_set_pointer, gy_value_push_pointer},
+  {G_TYPE_VARIANT, gy_value_set_variant, gy_value_push_variant},
+  {G_TYPE_BOXED,   gy_value_set_boxed,   gy_value_push_boxed},
+};
+
+/* Fill in the description of flat structure GTYPE in C, if it is
+   one. */
+static void
+gy_value_conv_flat(gy_ValueConv * c, GType gtype)
+{
+  GIBaseInfo * info = gy_info_from_gtype(gtype);
+  gint i, n;
+  gsize sz = 0;
+  GITypeTag tag = GI_TYPE_TAG_VOID;
+
+  if (!info || !GI_IS_STRUCT_INFO(info)) return;
+  n = g_struct_info_get_n_fields(info);
+  for (i=0; i<n; ++i) {
+    GIFieldInfo * fi = g_struct_info_get_field(info, i);
+    GITypeInfo * ti = g_field_info_get_type(fi);
+    GITypeTag t = g_type_info_get_tag(ti);
+    gint offset = g_field_info_get_offset(fi);
+    g_base_info_unref(ti);
+    g_base_info_unref(fi);
+    if (!i) {
+      tag = t;
+      sz = gy_type_tag_size(t);
+    }
+    if (t != tag || !sz || t == GI_TYPE_TAG_BOOLEAN ||
+	t == GI_TYPE_TAG_INT64 || t == GI_TYPE_TAG_UINT64 ||
+	t == GI_TYPE_TAG_UTF8 || t == GI_TYPE_TAG_FILENAME ||
+	t == GI_TYPE_TAG_GTYPE || t == GI_TYPE_TAG_UNICHAR ||
+	offset != i*sz)
+      return;
+  }
+  if (!n || g_struct_info_get_size(info) != n*sz) return;
+  c -> n_cells = n;
+  c -> cell_tag = tag;
+  c -> struct_size = n*sz;
+}
+
+const gy_ValueConv *
+gy_value_conv_for(GType gtype)
+{
+  gy_ValueConv * c;
+  GType t;
+  guint i;
+
+  if (!gy_value_convs) {
+    static const gy_ValueConv specials[] = {
+      {0, gy_value_set_gtype,       gy_value_push_gtype},
+      {0, gy_value_set_strv,        gy_value_push_strv},
+      {0, gy_value_set_value_array, gy_value_push_value_array},
+      {0, gy_value_set_bytes,       gy_value_push_bytes},
+    };
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+    GType stypes[] = {G_TYPE_GTYPE, G_TYPE_STRV,
+		      G_TYPE_VALUE_ARRAY, G_TYPE_BYTES};
+    G_GNUC_END_IGNORE_DEPRECATIONS
+    gy_value_convs = g_hash_table_new(NULL, NULL);
+    for (i=0; i<G_N_ELEMENTS(gy_value_basic_convs); ++i)
+      g_hash_table_insert(gy_value_convs,
+			  GSIZE_TO_POINTER(gy_value_basic_convs[i].gtype),
+			  (gpointer) (gy_value_basic_convs+i));
+    for (i=0; i<G_N_ELEMENTS(specials); ++i) {
+      c = g_new(gy_ValueConv, 1);
+      memcpy(c, specials+i, sizeof(gy_ValueConv));
+      c -> gtype = stypes[i];
+      g_hash_table_insert(gy_value_convs, GSIZE_TO_POINTER(c->gtype), c);
+    }
+  }
+
+  c = g_hash_table_lookup(gy_value_convs, GSIZE_TO_POINTER(gtype));
+  if (c) return c;
+
+  for (t=g_type_parent(gtype); t && !c; t=g_type_parent(t))
+    c = g_hash_table_lookup(gy_value_convs, GSIZE_TO_POINTER(t));
+  if (!c) c = g_hash_table_lookup(gy_value_convs,
+				  GSIZE_TO_POINTER(G_TYPE_FUNDAMENTAL(gtype)));
+  if (!c) return NULL;
+
+  if (G_TYPE_FUNDAMENTAL(gtype) == G_TYPE_BOXED) {
+    // each boxed type gets its own converter
+    gy_ValueConv * proto = c;
+    c = g_new(gy_ValueConv, 1);
+    memcpy(c, proto, sizeof(gy_ValueConv));
+    c -> gtype = gtype;
+    gy_value_conv_flat(c, gtype);
+  }
+  g_hash_table_insert(gy_value_convs, GSIZE_TO_POINTER(gtype), c);
+  return c;
+}
@@ -20,23 +20,13 @@
 #include "gy.h"
 #include "ctype.h"
 
-void gy_sa_handler(int sig) {
-  const char * ssig="(signal name unknown)";
-  switch (sig) {
-  case SIGABRT:
-    ssig="SIGABRT";
-    break;
-  case SIGSEGV:
-    ssig="SIGSEGV";
-    break;
-  default:
-    break;
-  }
-  y_errorq("gy action received signal %s", ssig);
-}
-
 /// GIBASEINFO
 
+static void gy_Object_call(gy_Object * o, gy_Plan * plan, int argc);
+static glong gy_List_size(gy_Object * o);
+static gpointer gy_List_nth(gy_Object * o, glong idx);
+static void gy_List_push_data(gy_Object * o, gpointer data);
+
 static y_userobj_t gy_Object_obj =
   {"gy_Object",
    &gy_Object_free,
@@ -48,10 +38,20 @@ static y_userobj_t gy_Object_obj =
 
 void gy_Object_free(void *obj) {
   gy_Object* o = (gy_Object*) obj;
+  if (o->object && o->boxed) {
+    // GVariant is a fundamental type, not a boxed one
+    if (o->boxed == G_TYPE_VARIANT) g_variant_unref((GVariant*) o->object);
+    else g_boxed_free(o->boxed, o->object);
+    o->object=NULL;
+  }
+  if (o->object && o->owned) {
+    g_free(o->object);
+    o->object=NULL;
+  }
   if (o->object) {
     // I don't know how reference counting works here...
     // if (GI_IS_STRUCT_INFO(o->info)) g_free(o->object);
-    if (o->info && GI_IS_OBJECT_INFO(o->info)) {
+    if (o->bound || o->lazy || (o->info && GI_IS_OBJECT_INFO(o->info))) {
       GY_DEBUG("Unref'ing GObject %p with refcount %d... ",
 	       o->object, o->object->ref_count);
       g_object_unref(o->object);
@@ -93,7 +93,7 @@ void gy_Object_print(void *obj) {
     y_print(spointer, 0);
     y_print(" is pointer to ", 0);
   }
-  if (!o->info) {
+  if (!gy_Object_resolve(o)) {
     y_print("unknown type object", 0);
     return;
   }
@@ -126,7 +126,7 @@ gy_Object_extract(void *obj, char * name)
 {
   gy_Object * o = (gy_Object *) obj;
 
-  if (!o->info) y_error("Object has no type information");
+  if (!gy_Object_resolve(o)) y_error("Object has no type information");
   
   if (GI_IS_TYPE_INFO(o->info)) {
     GITypeTag type = g_type_info_get_tag(o->info);
@@ -156,44 +156,33 @@ gy_Object_extract(void *obj, char * name)
 	}
 
 	if (action == GYLIST_ACTION_SIZE) {
-	  GList* lst = (GList*) o->object;
-	  if (!lst) {
-	    ypush_long(0);
-	    return;
-	  }
-	  long sz=1;
-	  while (lst=lst->next) ++sz;
-	  ypush_long(sz);
+	  ypush_long(gy_List_size(o));
 	  return;
 	}
 
 	if (action == GYLIST_ACTION_PREV && type == GI_TYPE_TAG_GSLIST)
 	  y_error("Single-linked list: no prev");
 
-	if ( (action == GYLIST_ACTION_NEXT && !((GList*) o->object) -> next) ||
-	     (action == GYLIST_ACTION_PREV && !((GList*) o->object) -> prev) ) {
-	  ypush_nil();
+	if (action == GYLIST_ACTION_DATA) {
+	  gy_List_push_data(o, ((GList*) o->object) -> data);
 	  return;
 	}
 
-	GITypeInfo * itrf = g_type_info_get_interface(g_type_info_get_param_type(o->info, 0));
-
+	GList * lnk = action==GYLIST_ACTION_NEXT ?
+	  ((GList*) o->object) -> next : ((GList*) o->object) -> prev;
+	if (!lnk) {
+	  ypush_nil();
+	  return;
+	}
 	gy_Object * out = ypush_gy_Object();
 	out -> repo = o -> repo;
-	if (action == GYLIST_ACTION_DATA) {
-	  out -> info = itrf;
-	  out -> object = ((GList*) o->object) -> data;
-	  if (g_base_info_get_type (itrf) == GI_INFO_TYPE_OBJECT) {
-	    g_object_ref(out -> object);
-	  }
-	} else {
-	  out -> info = o -> info;
-	  if (action==GYLIST_ACTION_NEXT)
-	    out -> object = (GObject*) ((GList*) o->object) -> next;
-	  else if (action==GYLIST_ACTION_PREV)
-	    out -> object = (GObject*) ((GList*) o->object) -> prev;
+	out -> info = g_base_info_ref(o -> info);
+	out -> object = (GObject*) lnk;
+	// the tail of a list is one shorter
+	if (o->list_sized && action==GYLIST_ACTION_NEXT) {
+	  out -> list_sized = TRUE;
+	  out -> list_size = o->list_size - 1;
 	}
-	g_base_info_ref(out -> info);
 	return;
       }
       break;
@@ -203,31 +192,10 @@ gy_Object_extract(void *obj, char * name)
   }
 
   if (GI_IS_ENUM_INFO(o->info)) {
-    
-    gint64 wtype=-1;
-    gint nc = g_enum_info_get_n_values (o->info);
-    GIValueInfo * ci ;
-    gint i;
-    gboolean tfound=0;
-    char * name_dn = p_strtolower(name);
-    if (!strcmp(name, name_dn)) {
-      p_free(name_dn);
-      name_dn=NULL;
-    }
-    for (i=0; i<nc; ++i) {
-      ci = g_enum_info_get_value(o->info, i);
-      if (!strcmp(g_base_info_get_name (ci), name) ||
-	  (name_dn && !strcmp(g_base_info_get_name (ci), name_dn)) ) {
-	wtype=g_value_info_get_value (ci);
-	tfound=1;
-	g_base_info_unref(ci);
-	break;
-      }
-      g_base_info_unref(ci);
-    }
-    p_free(name_dn);
-    if (tfound) ypush_long(wtype);
-    else y_errorq("No such enum value: %s", name);
+    gint64 value;
+    if (!gy_Class_find_value(gy_Class_get(o->info), name, &value))
+      y_errorq("No such enum value: %s", name);
+    ypush_long(value);
     return;
   }
 
@@ -244,36 +212,21 @@ gy_Object_extract(void *obj, char * name)
     GY_DEBUG("Looking for method %s in %s\n",
 	   name,
 	   g_base_info_get_name(o->info));
-    if (isobject)
-      info = g_object_info_find_method (o->info, name);
-    else if (isitrf)
-      info = g_interface_info_find_method (o->info, name);
-    else
-      info = g_struct_info_find_method (o->info, name);
-
-    GIBaseInfo * cur = o->info, *next;
-    g_base_info_ref(cur);
-    while (!info && isobject &&
-	   (next = g_object_info_get_parent(cur))) {
-      g_base_info_unref(cur);
-      cur = next;
-      GY_DEBUG("Looking for method %s in parent %s\n",
-	     name,
-	     g_base_info_get_name(cur));
-      info = g_object_info_find_method (cur, name);
-    }
+    info = gy_Class_find_method(gy_Class_get(o->info), name);
     if (info) {
       GY_DEBUG("Method %s found in %s\n",
 	     name,
-	     g_base_info_get_name(cur));
-      g_base_info_unref(cur);
+	     g_base_info_get_name(g_base_info_get_container(info)));
       gy_Object * out = ypush_gy_Object();
-      out->info = info;
+      out->info = g_base_info_ref(info);
       out->repo = o->repo;
       if (g_function_info_get_flags (info) & GI_FUNCTION_IS_METHOD) {
 	// a method needs an object!
 	out->object=o->object;
-	if (isobject) g_object_ref(o->object);
+	if (isobject) {
+	  g_object_ref(o->object);
+	  out->bound=1;
+	}
       }
       return;
     }
@@ -284,42 +237,27 @@ gy_Object_extract(void *obj, char * name)
     GY_DEBUG("Looking for property %s in %s\n",
 	     name,
 	     g_base_info_get_name(o->info));
-    ystring_t name2 = p_strcpy(name);
-    GIPropertyInfo * cur = gy_base_info_find_property_info(o->info, name2);
-    if (cur) {
+    gy_Property * prop = gy_Class_find_property(gy_Class_get(o->info), name);
+    if (prop) {
+      if (!o->object) y_error("Object is NULL");
+      if (!(prop->flags & G_PARAM_READABLE))
+	y_error("property is not readable");
       GValue val=G_VALUE_INIT;
-      GITypeInfo * ti = g_property_info_get_type(cur);
-      g_value_init(&val,
-		   g_object_class_find_property(G_OBJECT_GET_CLASS(o->object),
-						name2)->value_type);
-      g_object_get_property(o->object, name2, &val);
-      gy_value_push(&val, ti, o);
-      g_base_info_unref(ti);
-
-      p_free(name2);
+      gy_Property_value_init(prop, &val);
+      g_object_get_property(o->object, prop->name, &val);
+      gy_Property_value_push(prop, &val, o);
+      g_value_unset(&val);
       return;
     }
-    p_free(name2);
   }
 
   /// Look for field
   if (isobject || isstruct) {
-    ystring_t name2 = p_strcpy(name);
-    GIBaseInfo * cur = gy_base_info_find_field_info(o->info, name2);
-    if (cur) {
-      GITypeInfo * ti = g_field_info_get_type(cur);
-      GIArgument rarg;
-      gboolean success=g_field_info_get_field(cur, o->object, &rarg);
-      if (!success)
-	y_error("get field failed");
-
-      gy_Argument_pushany(&rarg, ti, o);
-
-      g_base_info_unref(ti);
-      p_free(name2);
+    gy_Field * field = gy_Class_find_field(gy_Class_get(o->info), name);
+    if (field) {
+      gy_Field_push(field, o->object, o);
       return;
     }
-    p_free(name2);
   }
 
   /// Look for signal
@@ -333,26 +271,11 @@ gy_Object_extract(void *obj, char * name)
       GY_DEBUG("Looking for signal %s in %s\n",
 	       name,
 	       g_base_info_get_name(o->info));
-      
-      
-      gint nc = g_object_info_get_n_signals (o->info);
-      
-      GY_DEBUG("%s has %d signals\n", g_base_info_get_name(o->info), nc);
-      
-      GISignalInfo * ci=NULL ;
-      gint i;
-      
-      for (i=0; i<nc; ++i) {
-	ci = g_object_info_get_signal(o->info, i);
-	if (!strcmp(g_base_info_get_name (ci), name)) {
-	  info=ci;
-	  break;
-	}
-	g_base_info_unref(ci);
-      }
-      if (info) {
+
+      gy_Signal * sig = gy_Class_find_signal(gy_Class_get(o->info), name);
+      if (sig) {
 	gy_Object * out = ypush_gy_Object();
-	out -> info = info;
+	out -> info = g_base_info_ref(sig->info);
 	out->repo = o->repo;
 	return;
       }
@@ -376,9 +299,14 @@ gy_Object_eval(void *obj, int argc)
 {
   GY_DEBUG("in gy_Object_eval\n");
   gy_Object* o = (gy_Object*) obj;
-  GError * err = NULL;
 
-  if (!o -> info)
+  // bound method handle: everything is already resolved
+  if (o->plan) {
+    gy_Object_call(o, o->plan, argc);
+    return;
+  }
+
+  if (!gy_Object_resolve(o))
     y_error("Object lacks type information. "
 	    "Please cast it appropriately");
 
@@ -392,23 +320,7 @@ gy_Object_eval(void *obj, int argc)
     if (type !=GI_TYPE_TAG_GLIST && type !=GI_TYPE_TAG_GSLIST)
       y_error("Unimplemented");
     if (!o->object) y_error("G(S)List is nil");
-    GList* lst = (GList*) o->object;
-    long idx = ygets_l(argc-1)-1;
-    gy_Object * out = ypush_gy_Object();
-    if (type !=GI_TYPE_TAG_GLIST)
-      out->object=g_list_nth_data (lst, idx);
-    else if (type !=GI_TYPE_TAG_GSLIST)
-      out->object=g_slist_nth_data ((GSList*)lst, idx);
-    if (!out->object) y_error("index out of range");
-    
-    GITypeInfo * itrf =
-      g_type_info_get_interface(g_type_info_get_param_type(o->info, 0));
-    out -> repo = o -> repo;
-    out -> info = itrf;
-    if (g_base_info_get_type (itrf) == GI_INFO_TYPE_OBJECT) {
-      g_object_ref(out -> object);
-    }
-    g_base_info_ref(out -> info);
+    gy_List_push_data(o, gy_List_nth(o, ygets_l(argc-1)-1));
     return;
   }
 
@@ -427,7 +339,7 @@ gy_Object_eval(void *obj, int argc)
 	GY_DEBUG("here\n");
 	out -> object = ino -> object;
 	GY_DEBUG("here\n");
-	if ((ino->info && GI_IS_OBJECT_INFO(ino->info)) ||
+	if (ino->lazy || (ino->info && GI_IS_OBJECT_INFO(ino->info)) ||
 	    GI_IS_OBJECT_INFO(out->info)) {
 	  GY_DEBUG("This is an object, referencing\n");
 	  g_object_ref(out->object);
@@ -443,26 +355,25 @@ gy_Object_eval(void *obj, int argc)
 	  guint p;
 	  int iarg=argc;
 	  long index;
-	  GIPropertyInfo * cur;
-	  GITypeInfo * ti;
+	  char * pname;
+	  gy_Property * prop;
+	  gy_Class * klass = gy_Class_get(o->info);
 
 	  for (p=0; p<n_parameters; ++p) {
 	    index=yarg_key(iarg);
 	    GY_DEBUG("index=%ld\n", index);
-	    if (index<0) parameters[p].name = ygets_q(iarg);
-	    else parameters[p].name=yfind_name(index);
+	    if (index<0) pname = ygets_q(iarg);
+	    else pname=yfind_name(index);
 
-	    cur = gy_base_info_find_property_info(o->info, parameters[p].name);
-	    GY_DEBUG("Property info:%p\n", cur);
-	    if (!cur) y_errorq("No such porperty in object: \"%s\"", parameters[p].name);
+	    prop = gy_Class_find_property(klass, pname);
+	    GY_DEBUG("Property info:%p\n", prop);
+	    if (!prop) y_errorq("No such porperty in object: \"%s\"", pname);
 	    --iarg;
+	    parameters[p].name = prop->name;
 	    GY_DEBUG("property name=\"%s\"\n", parameters[p].name);
-	    ti  = g_property_info_get_type(cur);
-	    g_base_info_unref(cur);
-	    gy_value_init(&(parameters[p].value), ti);
-	    gy_value_set_iarg(&(parameters[p].value), ti, iarg);
+	    gy_Property_value_init(prop, &(parameters[p].value));
+	    gy_Property_value_set(prop, &(parameters[p].value), iarg);
 	    --iarg;
-	    g_base_info_unref(ti);
 	  }
 	}
 	out -> object =
@@ -495,16 +406,24 @@ gy_Object_eval(void *obj, int argc)
     int iarg = argc; // last is newly pushed reference
     long index;
     char * name;
-    GIBaseInfo * cur=NULL;
-    GITypeInfo * ti;
     gboolean getting=0;
-    GParamFlags pf;
     GIArgument rarg;
+    gy_Property * prop;
+    gy_Field * field;
+    gy_Class * klass = gy_Class_get(o->info);
+    gy_PropBatch * batch = NULL;
 
     if (argc==1 && yarg_nil(iarg)) return;
 
     int lim=0;
-    while (iarg > lim) { // 0 is output
+    if ((isobject || isitrf) && argc) {
+      if (!G_IS_OBJECT(out->object)) y_error("Object is not a GObject");
+      // properties are applied together once all arguments are parsed
+      batch = gy_PropBatch_push(out->object, argc/2+1);
+      ++iarg;
+      lim=1;
+    }
+    while (iarg > lim) { // lim is output (and batch)
       index=yarg_key(iarg);
       GY_DEBUG("Key iarg: %d, index: %ld\n", iarg, index);
       if (index<0) {
@@ -519,79 +438,202 @@ gy_Object_eval(void *obj, int argc)
 	GY_DEBUG("Setting member %s\n", name);
       }
 
-      if ( (cur = gy_base_info_find_property_info(o->info, name)) ) {
+      if ( batch && (prop = gy_Class_find_property(klass, name)) ) {
 	/* NAME is property */ 
-	GY_DEBUG("Canonical property name: %s\n",name);
-	ti = g_property_info_get_type(cur);
-	pf = g_property_info_get_flags (cur);
-
-	GValue val=G_VALUE_INIT;
-	g_value_init(&val,
-		     g_object_class_find_property(G_OBJECT_GET_CLASS(o->object),
-						  name)->value_type);
-
+	GY_DEBUG("Canonical property name: %s\n", prop->name);
 	iarg--;
 	if (getting) {
-	  if (!(pf & G_PARAM_READABLE)) y_error("property is not readable");
-	  GY_DEBUG("Getting property %s", name);
 	  long idx=yget_ref(iarg);
 	  GY_DEBUG("Output variable iarg: %d, index: %ld\n", iarg, idx);
-	  g_object_get_property(o->object, name, &val);
-	  gy_value_push(&val, ti, o);
-	  yput_global(idx, 0);
-	  yarg_drop(1);
-	  GY_DEBUG("done.\n");
+	  gy_PropBatch_get(batch, prop, idx);
 	} else {
-	  if (!(pf & G_PARAM_WRITABLE)) y_error("property is not writable");
-	  GY_DEBUG("Setting property %s\n", name);
-	  gy_value_set_iarg(&val, ti, iarg);
-	  g_object_set_property(o->object, name, &val);
+	  GY_DEBUG("Setting property %s\n", prop->name);
+	  gy_PropBatch_set(batch, prop, iarg);
 	}
-	g_base_info_unref(ti);
-      } else if ( (cur = gy_base_info_find_field_info(o->info, name)) ) {
+      } else if ( (isobject || isstruct) &&
+		  (field = gy_Class_find_field(klass, name)) ) {
 	/* NAME is field */
 	GY_DEBUG("Member %s is a Field.\n", name);
-	ti = g_field_info_get_type(cur);
-	if (getting) { //y_error("Getting");
+	iarg--;
+	if (getting) {
 	  GY_DEBUG("getting\n");
-	  long idx = yget_ref(iarg-1);
-	  gboolean success=g_field_info_get_field(cur, o->object, &rarg);
-	  if (!success)
-	    y_error("get field failed");
-	  gy_Argument_pushany(&rarg, ti, o);
+	  long idx = yget_ref(iarg);
+	  gy_Field_push(field, out->object, o);
 	  yput_global(idx, 0);
 	  yarg_drop(1);
 	} else {
-	  gy_Argument_getany(&rarg, ti, --iarg);
-	  if (!g_field_info_set_field(cur, out->object, &rarg))
+	  gy_Argument_getany(&rarg, field->type, iarg);
+	  if (!g_field_info_set_field(field->info, out->object, &rarg))
 	    y_error("set field failed");
 	}
-	g_base_info_unref(ti);
       } else y_errorq("%s is neither property not field", name);
       --iarg;
     }
 
+    if (batch) {
+      gy_PropBatch_apply(batch, o);
+      yarg_drop(1);
+    }
     return;
   }
 
-  if (!GI_IS_CALLABLE_INFO(o->info))
+  if (!GI_IS_FUNCTION_INFO(o->info))
     y_error("Object is not callable");
 
-  gint n_args = g_callable_info_get_n_args(o->info);
-  if ((argc != n_args) && !(n_args==0 && argc==1 && yarg_nil(0)))
-    y_errorn("function takes %ld arguments", n_args);
+  gy_Object_call(o, gy_Plan_get(o->info), argc);
+}
+
+/* Number of elements of argument IARG, 0 if nil. */
+static long
+gy_yarg_count(int iarg)
+{
+  long ntot = 0;
+  if (!yarg_nil(iarg)) ygeta_any(iarg, &ntot, NULL, NULL);
+  return ntot;
+}
+
+/* Push value ARG of type INFO. The length of arrays is read from
+   argument LENGTH (-1 if none) of the call, LOCS giving where the
+   value of each argument is stored. */
+static void
+gy_Object_pushresult(GIArgument * arg, GITypeInfo * info, gint length,
+		     GIArgument ** locs, gy_Plan * plan, GITransfer transfer,
+		     gy_Object * o)
+{
+  long len;
+  if (g_type_info_get_tag(info) != GI_TYPE_TAG_ARRAY) {
+    gy_Argument_pushany(arg, info, o);
+    if (transfer != GI_TRANSFER_NOTHING && arg->v_pointer) {
+      if (gy_type_is_bytes(info)) g_bytes_unref(arg->v_pointer);
+      else if (gy_type_is_variant(info)) g_variant_unref(arg->v_pointer);
+    }
+    return;
+  }
+  if (length >= 0)
+    len = gy_Argument_get_long(locs[length], plan->slots[length].type);
+  else if ((len = gy_Argument_array_length(arg, info)) < 0)
+    y_error("array of unknown length");
+  gy_Argument_pusharray(arg, info, len, transfer);
+}
+
+/* The structure of caller-allocated SLOT, pushed on top of the stack,
+   lives in the scratch arena: give the object its own copy. */
+static void
+gy_Object_keepstruct(gy_Slot * slot)
+{
+  gy_Object * out;
+  if (!slot->caller_allocates || !yarg_gy_Object(0)) return;
+  out = yget_gy_Object(0);
+  if (!out->object) return;
+  if (slot->gtype == G_TYPE_VALUE) {
+    // take the value over, leaving nothing to unset in the arena
+    GValue * val = g_new(GValue, 1);
+    memcpy(val, out->object, sizeof(GValue));
+    memset(out->object, 0, sizeof(GValue));
+    out -> object = (GObject*) val;
+    out -> boxed = G_TYPE_VALUE;
+  } else if (G_TYPE_IS_BOXED(slot->gtype)) {
+    out -> object = g_boxed_copy(slot->gtype, out->object);
+    out -> boxed = slot->gtype;
+  } else {
+    gpointer copy = g_malloc(slot->size);
+    memcpy(copy, out->object, slot->size);
+    out -> object = copy;
+    out -> owned = TRUE;
+  }
+}
+
+/* Unset VAL unless it was taken over by gy_Object_keepstruct. */
+static void
+gy_Object_unset_value(gpointer val)
+{
+  if (G_IS_VALUE(val)) g_value_unset(val);
+}
+
+/* Append value IVAL as an anonymous member to oxy object IOBJ. */
+static void
+gy_oxy_append(int iobj, int ival)
+{
+  void * obj = yget_use(iobj), * val = yget_use(ival);
+  ypush_global(yget_global("save", 0));
+  ypush_use(obj);
+  ydrop_use(obj);
+  *ypush_q(0) = NULL;
+  ypush_use(val);
+  ydrop_use(val);
+  yexec_call(3);
+  yarg_drop(1);
+}
 
-  GIArgument * in_args=g_new0(GIArgument,n_args+1);
-  GIArgument * out_args=g_new0(GIArgument,n_args);
+/* Push an oxy object holding the M values on top of the stack, in
+   order, as anonymous members. The values are left in place. */
+static void
+gy_Object_pack(long m)
+{
+  long j;
+  ypush_global(yget_global("save", 0));
+  yexec_call(0);
+  for (j=0; j<m; ++j) gy_oxy_append(0, m-j);
+}
 
-  GIArgInfo arginfo;
-  gint n_in=0, n_out=0, i;
+/* Call function O->info (bound to O->object if it is a method) with
+   the ARGC arguments on top of the stack, following PLAN. */
+static void
+gy_Object_call(gy_Object * o, gy_Plan * plan, int argc)
+{
+  GError * err = NULL;
+  gint n_args = plan->n_args;
+  // lengths of arrays may be omitted, they are then computed from
+  // the arrays; out arguments may be omitted, their values are then
+  // returned
+  gint n_short = n_args - plan->n_length;
+  if (argc==1 && yarg_nil(0) &&
+      (!n_args || !(n_short - plan->n_out_plain) ||
+       !(n_args - plan->n_out_only)))
+    argc=0;
+  gboolean skiplen = 0, collect = 0;
+  if (argc == n_args) ;
+  else if (plan->n_length && argc == n_short) skiplen = 1;
+  else if (plan->n_length && plan->n_out_plain &&
+	   argc == n_short - plan->n_out_plain)
+    skiplen = collect = 1;
+  else if (plan->n_out_only && argc == n_args - plan->n_out_only)
+    collect = 1;
+  else
+    y_errorn("function takes %ld arguments", n_args);
 
-  if (GI_IS_FUNCTION_INFO(o->info) &&
-      (g_function_info_get_flags (o->info) & GI_FUNCTION_IS_METHOD)) {
+  // temporaries live until the scope is dropped, or the stack is
+  // cleaned by an error
+  gy_arena_push_scope();
+  ++argc;
+
+  GIArgument in_small[GY_SMALL_ARITY], out_small[GY_SMALL_ARITY],
+    store_small[GY_SMALL_ARITY], * locs_small[GY_SMALL_ARITY];
+  long refs_small[GY_SMALL_ARITY];
+  int iargs_small[GY_SMALL_ARITY];
+  GIArgument * in_args = plan->n_in < GY_SMALL_ARITY ? in_small :
+    gy_arena_alloc((plan->n_in+1)*sizeof(GIArgument));
+  GIArgument * out_args = plan->n_out < GY_SMALL_ARITY ? out_small :
+    gy_arena_alloc((plan->n_out+1)*sizeof(GIArgument));
+  // values of the out arguments, and variables receiving them
+  GIArgument * store = plan->n_out < GY_SMALL_ARITY ? store_small :
+    gy_arena_alloc((plan->n_out+1)*sizeof(GIArgument));
+  long * refs = plan->n_out < GY_SMALL_ARITY ? refs_small :
+    gy_arena_alloc((plan->n_out+1)*sizeof(long));
+  // where the value of each argument is, and where it came from
+  GIArgument ** locs = n_args < GY_SMALL_ARITY ? locs_small :
+    gy_arena_alloc((n_args+1)*sizeof(GIArgument*));
+  int * iargs = n_args < GY_SMALL_ARITY ? iargs_small :
+    gy_arena_alloc((n_args+1)*sizeof(int));
+  memset(in_args, 0, (plan->n_in+1)*sizeof(GIArgument));
+  memset(out_args, 0, (plan->n_out+1)*sizeof(GIArgument));
+  memset(store, 0, (plan->n_out+1)*sizeof(GIArgument));
+
+  gint n_in=0, n_out=0, i, k=0, iarg;
+  gy_Slot * slot;
+
+  if (plan->is_method) {
     GY_DEBUG("Object address: %p\n", o->object);
-    GY_DEBUG("Is object: %d\n", G_IS_OBJECT(o->object));
-    GY_DEBUG("Object type name: %s\n", G_OBJECT_TYPE_NAME(o->object));
     if (!o -> object) y_error("NULL pointer");
     in_args[0].v_pointer= o -> object;
     ++n_in;
@@ -599,67 +641,72 @@ gy_Object_eval(void *obj, int argc)
 
   for (i=0; i<n_args;++i) {
     GY_DEBUG("Getting argument %d\n", i);
-    g_callable_info_load_arg (o->info, i, &arginfo);
-
-    GITypeInfo * argtype = g_arg_info_get_type(&arginfo);
-
-    switch (g_arg_info_get_direction(&arginfo)) {
+    slot = plan->slots+i;
+    gboolean hidden = skiplen && slot->is_length;
+    iargs[i] = -1;
+    switch (slot->direction) {
     case GI_DIRECTION_IN:
-      gy_Argument_getany(in_args+n_in,
-			 argtype,
-			 argc-i-1);
-      ++n_in;
+      locs[i] = in_args+n_in++;
+      if (hidden) break;
+      iargs[i] = argc-(k++)-1;
+      slot->marshal(locs[i], slot->type, iargs[i]);
+      if (slot->transfer != GI_TRANSFER_NOTHING &&
+	  g_type_info_get_tag(slot->type) == GI_TYPE_TAG_ARRAY)
+	gy_Argument_array_own(locs[i], slot->type,
+			      gy_yarg_count(iargs[i]), slot->transfer);
       break;
     case GI_DIRECTION_OUT:
-      gy_Argument_getany(out_args+n_out,
-			 argtype,
-			 argc-i-1);
+      refs[n_out] = -1;
+      if (!collect && !hidden) {
+	iarg = argc-(k++)-1;
+	if (!yarg_nil(iarg) && (refs[n_out] = yget_ref(iarg)) < 0)
+	  y_error("out argument must be a variable or nil");
+      }
+      if (slot->caller_allocates) {
+	// the callee fills a structure we provide, copied when pushed
+	store[n_out].v_pointer = gy_arena_alloc(slot->size);
+	memset(store[n_out].v_pointer, 0, slot->size);
+	if (slot->gtype == G_TYPE_VALUE)
+	  gy_arena_defer(&gy_Object_unset_value, store[n_out].v_pointer);
+	out_args[n_out].v_pointer = store[n_out].v_pointer;
+      } else out_args[n_out].v_pointer = store+n_out;
+      locs[i] = store+n_out;
       ++n_out;
       break;
     case GI_DIRECTION_INOUT:
-      gy_Argument_getany(in_args+n_in,
-			 argtype,
-			 argc-i-1);
-      ++n_in;
-      gy_Argument_getany(out_args+n_out,
-			 argtype,
-			 argc-i-1);
+      refs[n_out] = -1;
+      if (!hidden) {
+	iargs[i] = argc-(k++)-1;
+	refs[n_out] = yget_ref(iargs[i]);
+	slot->marshal(store+n_out, slot->type, iargs[i]);
+      }
+      in_args[n_in++].v_pointer = store+n_out;
+      out_args[n_out].v_pointer = store+n_out;
+      locs[i] = store+n_out;
       ++n_out;
       break;
     default:
       y_error("unknown GI_DIRECTION");
     }
-
-    g_base_info_unref(argtype);
   }
 
-  GIArgument retval;
-
-  fenv_t fenv_in;
-  if (feholdexcept(&fenv_in)) y_error("fenv error");
-
+  // fill in omitted lengths of input arrays
+  if (skiplen)
+    for (i=0; i<n_args; ++i) {
+      slot = plan->slots+i;
+      if (slot->length >= 0 && slot->direction != GI_DIRECTION_OUT)
+	gy_Argument_set_long(locs[slot->length],
+			     plan->slots[slot->length].type,
+			     gy_yarg_count(iargs[i]));
+    }
 
-  struct sigaction act, *oldact=NULL;
-  act.sa_handler=&gy_sa_handler;
-  sigemptyset(&act.sa_mask);
-  act.sa_flags=0;
-  sigaction(SIGABRT, &act, oldact);
-  sigaction(SIGSEGV, &act, oldact);
+  GIArgument retval;
 
   GY_DEBUG("Calling function %s... ", g_base_info_get_name(o->info));
 
-  gboolean success = g_function_info_invoke (o->info,
-					     in_args,
-					     n_in,
-					     out_args,
-					     n_out,
-					     &retval,
-					     &err);
+  gboolean success = gy_Plan_invoke(plan, in_args, out_args, &retval, &err);
   GY_DEBUG("done.\n");
 
-  sigaction(SIGABRT, oldact, NULL);
-
-  fesetenv(&fenv_in);
   if (!success) {
     GY_DEBUG("here\n");
     y_error(err->message);
@@ -667,12 +714,69 @@ gy_Object_eval(void *obj, int argc)
 
   GY_DEBUG("Function %s successfully called\n", g_base_info_get_name(o->info));
 
-  if (n_out)
-    y_warn("unimplemented: positional out arguments");
+  if (collect) {
+    // return value, if any, followed by the out values
+    gint m = 0, j;
+    gboolean isdouble = 0;
+    if (plan->rettag != GI_TYPE_TAG_VOID) {
+      gy_Object_pushresult(&retval, plan->rettype, plan->retlength, locs,
+			   plan, plan->rettransfer, o);
+      ++m;
+    }
+    for (i=0, j=0; i<n_args; ++i) {
+      slot = plan->slots+i;
+      if (slot->direction == GI_DIRECTION_IN) continue;
+      if (!(skiplen && slot->is_length)) {
+	gy_Object_pushresult(store+j, slot->type, slot->length, locs,
+			     plan, slot->transfer, o);
+	gy_Object_keepstruct(slot);
+	++m;
+      }
+      ++j;
+    }
+    if (m > 1) {
+      gboolean numeric = 1;
+      for (j=0; j<m; ++j) {
+	if (!yarg_number(j) || yarg_number(j) > 2 || yarg_rank(j) > 0)
+	  numeric = 0;
+	if (yarg_number(j) == 2) isdouble = 1;
+      }
+      long dims[Y_DIMSIZE] = {1, m};
+      if (!numeric) gy_Object_pack(m);
+      else if (isdouble) {
+	double * res = ypush_d(dims);
+	for (j=0; j<m; ++j) res[j] = ygets_d(m-j);
+      } else {
+	long * res = ypush_l(dims);
+	for (j=0; j<m; ++j) res[j] = ygets_l(m-j);
+      }
+      ++m;
+    }
+    // move the result above the scope and drop the rest
+    yarg_swap(0, m);
+    yarg_drop(m);
+    return;
+  }
 
-  GITypeInfo * retinfo = g_callable_info_get_return_type(o->info);
+  for (i=0, k=0; i<n_args; ++i) {
+    slot = plan->slots+i;
+    if (slot->direction == GI_DIRECTION_IN) continue;
+    if (refs[k] >= 0) {
+      gy_Object_pushresult(store+k, slot->type, slot->length, locs,
+			   plan, slot->transfer, o);
+      gy_Object_keepstruct(slot);
+      yput_global(refs[k], 0);
+      yarg_drop(1);
+    }
+    ++k;
+  }
 
-  gy_Argument_pushany(&retval, retinfo, o);
+  // the length of the result may be held in the scope: push the
+  // result before dropping the scope, releasing the temporaries
+  gy_Object_pushresult(&retval, plan->rettype, plan->retlength, locs,
+		       plan, plan->rettransfer, o);
+  yarg_swap(0, 1);
+  yarg_drop(1);
 
   /*
   if (g_function_info_get_flags (o->info) & GI_FUNCTION_IS_CONSTRUCTOR) {
@@ -692,11 +796,6 @@ gy_Object_eval(void *obj, int argc)
     g_base_info_ref(out->info);
   }
   */
-  GY_DEBUG("g_base_info_unref(retinfo)... ");
-  g_base_info_unref(retinfo); 
-  GY_DEBUG(" done.\n");
-  g_free (in_args);
-  g_free (out_args);
 
 }
 
@@ -708,10 +807,446 @@ gy_Object* ypush_gy_Object() {
   return (gy_Object*) ypush_obj(&gy_Object_obj, sizeof(gy_Object));
 }
 
+/* Objects returned by functions or passed to callbacks are pushed
+   with lazy set: their type is only looked up when it is needed. */
+GIBaseInfo *
+gy_Object_resolve(gy_Object * o)
+{
+  if (o->lazy && !o->info) {
+    o->info = gy_info_from_gtype(G_OBJECT_TYPE(o->object));
+    if (o->info) g_base_info_ref(o->info);
+  }
+  return o->info;
+}
+
+void
+Y_gy_bind(int argc)
+{
+  if (argc != 2) y_error("gy_bind takes exactly 2 arguments");
+  gy_Object * o = yget_gy_Object(1);
+  ystring_t name = ygets_q(0);
+  gboolean isobject;
+  GIFunctionInfo * info;
+
+  if (!gy_Object_resolve(o)) y_error("Object has no type information");
+  isobject = GI_IS_OBJECT_INFO(o->info);
+  if (!isobject && !GI_IS_STRUCT_INFO(o->info) && !GI_IS_INTERFACE_INFO(o->info))
+    y_error("can only bind methods of objects, interfaces and structures");
+  info = gy_Class_find_method(gy_Class_get(o->info), name);
+  if (!info) y_errorq("No such method: %s", name);
+
+  gboolean ismethod = g_function_info_get_flags(info) & GI_FUNCTION_IS_METHOD;
+  if (ismethod && !o->object) y_error("Object is NULL");
+  gy_Plan * plan = gy_Plan_get(info);
+
+  gy_Object * out = ypush_gy_Object();
+  out -> info = g_base_info_ref(info);
+  out -> repo = o->repo;
+  out -> plan = plan;
+  if (ismethod) {
+    out -> object = o->object;
+    // interface instances are GObjects too
+    if (isobject ||
+	(GI_IS_INTERFACE_INFO(o->info) && G_IS_OBJECT(o->object))) {
+      g_object_ref(out->object);
+      out -> bound = 1;
+    }
+  }
+}
+
+/// LISTS
+
+/*
+  G(S)List wrappers cache the length of the list and the last element
+  reached by index, so that both l.size and a loop over l(i) are
+  linear in the length of the list. GSList and GList share their
+  first two members: forward walks treat both as GSList.
+ */
+
+static glong
+gy_List_size(gy_Object * o)
+{
+  GSList * l;
+  if (!o->list_sized) {
+    o->list_size = 0;
+    for (l=(GSList*)o->object; l; l=l->next) ++o->list_size;
+    o->list_sized = TRUE;
+  }
+  return o->list_size;
+}
+
+/* Data of element IDX (0-based) of list O. */
+static gpointer
+gy_List_nth(gy_Object * o, glong idx)
+{
+  GSList * l = (GSList*) o->object;
+  glong i = 0;
+
+  if (idx < 0) y_error("index out of range");
+  if (o->cursor && idx >= o->cursor_idx) {
+    l = o->cursor;
+    i = o->cursor_idx;
+  } else if (o->cursor && g_type_info_get_tag(o->info) == GI_TYPE_TAG_GLIST
+	     && o->cursor_idx - idx < idx) {
+    GList * dl = (GList*) o->cursor;
+    for (i=o->cursor_idx; i>idx; --i) dl = dl->prev;
+    l = (GSList*) dl;
+  }
+  for (; l && i<idx; ++i) l = l->next;
+  if (!l) y_error("index out of range");
+  o->cursor = l;
+  o->cursor_idx = i;
+  return l->data;
+}
+
+/* Push DATA, an element of list O. */
+static void
+gy_List_push_data(gy_Object * o, gpointer data)
+{
+  GITypeInfo * cell = g_type_info_get_param_type(o->info, 0);
+  GITypeTag tag = g_type_info_get_tag(cell);
+  GIBaseInfo * itrf;
+  gy_Object * out;
+
+  switch (tag) {
+  case GI_TYPE_TAG_INTERFACE:
+    if (!data) {
+      ypush_nil();
+      break;
+    }
+    itrf = g_type_info_get_interface(cell);
+    out = ypush_gy_Object();
+    out -> repo = o -> repo;
+    out -> object = data;
+    if ((GI_IS_OBJECT_INFO(itrf) || GI_IS_INTERFACE_INFO(itrf)) &&
+	G_IS_OBJECT(data)) {
+      // the actual type is resolved by gy_Object_resolve if needed
+      g_object_ref(out -> object);
+      out -> lazy = TRUE;
+      g_base_info_unref(itrf);
+    } else out -> info = itrf;
+    break;
+  case GI_TYPE_TAG_UTF8:
+  case GI_TYPE_TAG_FILENAME:
+    *ypush_q(0) = p_strcpy(data);
+    break;
+  case GI_TYPE_TAG_GTYPE:
+    ypush_long(GPOINTER_TO_SIZE(data));
+    break;
+  case GI_TYPE_TAG_BOOLEAN:
+  case GI_TYPE_TAG_INT8:
+  case GI_TYPE_TAG_UINT8:
+  case GI_TYPE_TAG_INT16:
+  case GI_TYPE_TAG_UINT16:
+  case GI_TYPE_TAG_INT32:
+  case GI_TYPE_TAG_UINT32:
+  case GI_TYPE_TAG_UNICHAR:
+    ypush_long(GPOINTER_TO_INT(data));
+    break;
+  default:
+    g_base_info_unref(cell);
+    y_errorq("Unimplemented G(S)List element type: %s",
+	     g_type_tag_to_string(tag));
+  }
+  g_base_info_unref(cell);
+}
+
+void
+Y_gy_list_to_array(int argc)
+{
+  if (argc != 1) y_error("gy_list_to_array takes exactly one argument");
+  gy_Object * o = yget_gy_Object(0);
+  if (!gy_Object_resolve(o) || !GI_IS_TYPE_INFO(o->info) ||
+      (g_type_info_get_tag(o->info) != GI_TYPE_TAG_GLIST &&
+       g_type_info_get_tag(o->info) != GI_TYPE_TAG_GSLIST))
+    y_error("argument must be a G(S)List");
+
+  glong n = gy_List_size(o), i;
+  if (!n) {
+    ypush_nil();
+    return;
+  }
+
+  GITypeInfo * cell = g_type_info_get_param_type(o->info, 0);
+  GITypeTag tag = g_type_info_get_tag(cell);
+  g_base_info_unref(cell);
+  long dims[Y_DIMSIZE] = {1, n};
+  GSList * l = (GSList*) o->object;
+
+  switch (tag) {
+  case GI_TYPE_TAG_INTERFACE:
+    y_error("cannot convert a list of objects, use gy_map on the list");
+  case GI_TYPE_TAG_UTF8:
+  case GI_TYPE_TAG_FILENAME: {
+    ystring_t * res = ypush_q(dims);
+    for (i=0; i<n; ++i, l=l->next) res[i] = p_strcpy(l->data);
+    break;
+  }
+  case GI_TYPE_TAG_GTYPE: {
+    long * res = ypush_l(dims);
+    for (i=0; i<n; ++i, l=l->next) res[i] = GPOINTER_TO_SIZE(l->data);
+    break;
+  }
+  case GI_TYPE_TAG_BOOLEAN:
+  case GI_TYPE_TAG_INT8:
+  case GI_TYPE_TAG_UINT8:
+  case GI_TYPE_TAG_INT16:
+  case GI_TYPE_TAG_UINT16:
+  case GI_TYPE_TAG_INT32:
+  case GI_TYPE_TAG_UINT32:
+  case GI_TYPE_TAG_UNICHAR: {
+    long * res = ypush_l(dims);
+    for (i=0; i<n; ++i, l=l->next) res[i] = GPOINTER_TO_INT(l->data);
+    break;
+  }
+  default:
+    y_errorq("Unimplemented G(S)List element type: %s",
+	     g_type_tag_to_string(tag));
+  }
+}
+
+/// BATCH CALLS
+
+/* Source of one argument of gy_map: either a scalar, broadcast to all
+   objects, or an array holding one value per object. */
+typedef struct _gy_MapArg {
+  int type;    // Y_VOID, Y_LONG, Y_DOUBLE, Y_STRING or Y_OPAQUE (gy_Object)
+  long n;
+  void * data; // array data, or use of the gy_Object
+} gy_MapArg;
+
+/* The arguments of gy_map, held by a scratch object which drops the
+   uses of gy_Object arguments even if a call throws. */
+typedef struct _gy_MapArgs {
+  long n;
+  gy_MapArg * args;
+} gy_MapArgs;
+
+static void
+gy_MapArgs_free(void * data)
+{
+  gy_MapArgs * m = data;
+  long j;
+  for (j=0; j<m->n; ++j)
+    if (m->args[j].type == Y_OPAQUE && m->args[j].data)
+      ydrop_use(m->args[j].data);
+  g_free(m->args);
+}
+
+static void
+gy_MapArg_push(gy_MapArg * a, long i)
+{
+  if (a->n == 1) i = 0;
+  switch (a->type) {
+  case Y_LONG:
+    ypush_long(((long*)a->data)[i]);
+    break;
+  case Y_DOUBLE:
+    ypush_double(((double*)a->data)[i]);
+    break;
+  case Y_STRING:
+    *ypush_q(0) = p_strcpy(((char**)a->data)[i]);
+    break;
+  case Y_OPAQUE:
+    ypush_use(a->data);
+    break;
+  default:
+    ypush_nil();
+  }
+}
+
+/* Store result IARG in element I of RES, of type RTYPE. Objects are
+   appended to the oxy object at IOUT instead. */
+static void
+gy_map_store(void * res, int rtype, long i, int iarg, int iout)
+{
+  switch (rtype) {
+  case Y_LONG:
+    if (yarg_number(iarg) != 1) break;
+    ((long*)res)[i] = ygets_l(iarg);
+    return;
+  case Y_DOUBLE:
+    if (!yarg_number(iarg)) break;
+    ((double*)res)[i] = ygets_d(iarg);
+    return;
+  case Y_STRING:
+    if (!yarg_string(iarg)) break;
+    ((char**)res)[i] = p_strcpy(ygets_q(iarg));
+    return;
+  case Y_OPAQUE:
+    if (!yarg_gy_Object(iarg)) break;
+    gy_oxy_append(iout, iarg);
+    return;
+  case Y_VOID:
+    return;
+  }
+  y_error("gy_map: inconsistent result types");
+}
+
+void
+Y_gy_map(int argc)
+{
+  if (argc < 2) y_error("gy_map takes at least 2 arguments");
+  long n = 0, i, j, nargs = argc-2;
+  GObject ** objs;
+  gy_MapArgs * margs;
+  gy_MapArg * args;
+  gy_Object tmp = {0};
+  gy_Object * lo;
+  ystring_t name;
+
+  // temporaries and arguments; arguments are now two slots deeper
+  gy_arena_push_scope();
+  margs = ypush_scratch(sizeof(gy_MapArgs), &gy_MapArgs_free);
+  margs -> n = nargs;
+  margs -> args = args = g_new0(gy_MapArg, nargs+1);
+  argc += 2;
+
+  /* objects */
+  if (yarg_gy_Object(argc-1)) {
+    lo = yget_gy_Object(argc-1);
+    tmp.repo = lo->repo;
+    if (lo->info && GI_IS_TYPE_INFO(lo->info)) {
+      GITypeTag tag = g_type_info_get_tag(lo->info);
+      if (tag != GI_TYPE_TAG_GLIST && tag != GI_TYPE_TAG_GSLIST)
+	y_error("unsupported list type");
+      // GSList and GList share their first two members
+      GSList * l;
+      n = gy_List_size(lo);
+      objs = gy_arena_alloc(n*sizeof(GObject*));
+      for (l=(GSList*)lo->object, i=0; l; l=l->next, ++i) objs[i] = l->data;
+    } else {
+      n = 1;
+      objs = gy_arena_alloc(sizeof(GObject*));
+      objs[0] = lo->object;
+    }
+  } else if (yarg_number(argc-1) == 1) {
+    long * ids = ygeta_l(argc-1, &n, NULL);
+    objs = gy_arena_alloc(n*sizeof(GObject*));
+    // only ids handed out by gy_id, of objects still alive
+    for (i=0; i<n; ++i)
+      if (!(objs[i] = gy_id_lookup(ids[i])))
+	y_errorn("unknown id, or object destroyed: %ld", ids[i]);
+  } else
+    y_error("first argument must be an object, a G(S)List or an array of ids");
+  for (i=0; i<n; ++i)
+    if (!objs[i] || !G_IS_OBJECT(objs[i]))
+      y_error("gy_map only works on GObjects");
+
+  name = ygets_q(argc-2);
+
+  /* arguments */
+  for (j=0; j<nargs; ++j) {
+    int iarg = argc-3-j;
+    gy_MapArg * a = args+j;
+    a->n = 1;
+    if (yarg_nil(iarg)) a->type = Y_VOID;
+    else if (yarg_gy_Object(iarg)) {
+      a->type = Y_OPAQUE;
+      a->data = yget_use(iarg);
+    } else if (yarg_string(iarg)) {
+      a->type = Y_STRING;
+      a->data = ygeta_q(iarg, &a->n, NULL);
+    } else if (yarg_number(iarg) == 1) {
+      a->type = Y_LONG;
+      a->data = ygeta_l(iarg, &a->n, NULL);
+    } else if (yarg_number(iarg) == 2) {
+      a->type = Y_DOUBLE;
+      a->data = ygeta_d(iarg, &a->n, NULL);
+    } else y_error("unsupported argument type in gy_map");
+    if (a->n != 1 && a->n != n)
+      y_error("arguments must have one element or one per object");
+  }
+
+  /* loop; the method or property is resolved again only when the
+     type of the object changes */
+  GType last = G_TYPE_INVALID, t;
+  gy_Plan * plan = NULL;
+  gy_Property * prop = NULL;
+  int rtype = Y_VOID;
+  void * res = NULL;
+  long dims[Y_DIMSIZE] = {1, n};
+
+  for (i=0; i<n; ++i) {
+    t = G_OBJECT_TYPE(objs[i]);
+    if (t != last) {
+      last = t;
+      tmp.info = gy_info_from_gtype(t);
+      if (!tmp.info) y_errorq("unable to find object type for %s",
+			      G_OBJECT_TYPE_NAME(objs[i]));
+      gy_Class * klass = gy_Class_get(tmp.info);
+      GIFunctionInfo * fi = gy_Class_find_method(klass, name);
+      plan = fi ? gy_Plan_get(fi) : NULL;
+      prop = fi ? NULL : gy_Class_find_property(klass, name);
+      if (!plan && !prop)
+	y_errorq("%s is neither a method nor a property", name);
+      if (plan && !plan->is_method) y_errorq("%s is not a method", name);
+      if (prop && nargs > 1)
+	y_error("a property takes at most one value");
+    }
+    tmp.object = objs[i];
+
+    for (j=0; j<nargs; ++j) gy_MapArg_push(args+j, i);
+
+    if (plan) gy_Object_call(&tmp, plan, nargs);
+    else {
+      GValue val=G_VALUE_INIT;
+      gy_Property_value_init(prop, &val);
+      if (nargs) {
+	if (!(prop->flags & G_PARAM_WRITABLE))
+	  y_error("property is not writable");
+	gy_Property_value_set(prop, &val, 0);
+	g_object_set_property(tmp.object, prop->name, &val);
+	ypush_nil();
+      } else {
+	if (!(prop->flags & G_PARAM_READABLE))
+	  y_error("property is not readable");
+	g_object_get_property(tmp.object, prop->name, &val);
+	gy_Property_value_push(prop, &val, &tmp);
+      }
+      g_value_unset(&val);
+    }
+
+    if (!i) {
+      // the first result decides the type of the output
+      if (yarg_nil(0)) rtype = Y_VOID;
+      else if (yarg_string(0)) rtype = Y_STRING;
+      else if (yarg_number(0) == 1) rtype = Y_LONG;
+      else if (yarg_number(0) == 2) rtype = Y_DOUBLE;
+      else if (yarg_gy_Object(0)) rtype = Y_OPAQUE;
+      else y_error("gy_map: unsupported result type");
+      switch (rtype) {
+      case Y_STRING:
+	res = ypush_q(dims);
+	break;
+      case Y_DOUBLE:
+	res = ypush_d(dims);
+	break;
+      case Y_LONG:
+	res = ypush_l(dims);
+	break;
+      case Y_OPAQUE:
+	// the wrappers hold the references on the objects
+	ypush_global(yget_global("save", 0));
+	yexec_call(0);
+	break;
+      }
+      if (rtype != Y_VOID) {
+	gy_map_store(res, rtype, i, 1, 0);
+	// move the output below this iteration's arguments and result
+	yarg_swap(0, nargs+1);
+      }
+    } else gy_map_store(res, rtype, i, 0, nargs+1);
+    yarg_drop(nargs+1);
+  }
+
+  if (rtype == Y_VOID) ypush_nil();
+}
+
 void
 gy_Object_list(int argc) {
   gy_Object * o = yget_gy_Object(0);
-  if (!o->info) printf("object without type information.\n");
+  if (!gy_Object_resolve(o)) y_error("object without type information");
   printf("gy object name: %s, type: %s, namespace: %s\n",
 	 g_base_info_get_name(o->info),
 	 g_info_type_to_string(g_base_info_get_type (o->info)),
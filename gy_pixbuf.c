@@ -0,0 +1,151 @@
+/*
+    Copyright 2013 Thibaut Paumard
+
+    This file is part of gy (GObject Introspection for Yorick).
+
+    Gyoto is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gyoto is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gy.h"
+
+/// PIXBUF
+
+/*
+  Conversion between char(nc, width, height) arrays and GdkPixbuf.
+  The pixbuf is built and read through its GObject properties, so that
+  gy does not need to link with gdk-pixbuf: the library is loaded with
+  its typelib.
+
+  A Yorick image is contiguous, so the pixbuf simply wraps its memory
+  with a rowstride of nc*width. The other way round, rows are copied
+  one by one when the pixbuf has padding, else in a single block.
+ */
+
+static GType
+gy_pixbuf_type(void)
+{
+  static GType gtype = 0;
+  GError * err = NULL;
+  GIBaseInfo * info;
+
+  if (gtype) return gtype;
+  if (!g_irepository_require(NULL, "GdkPixbuf", NULL, 0, &err))
+    y_error(err->message);
+  info = g_irepository_find_by_name(NULL, "GdkPixbuf", "Pixbuf");
+  if (!info) y_error("GdkPixbuf.Pixbuf not found");
+  gtype = g_registered_type_info_get_g_type(info);
+  g_base_info_unref(info);
+  return gtype;
+}
+
+/* Push a new pixbuf wrapping image IARG. */
+static void
+gy_pixbuf_from_array(int iarg)
+{
+  long dims[Y_DIMSIZE], ntot, i;
+  int typeid;
+  GType gtype = gy_pixbuf_type();
+  GBytes * bytes;
+  unsigned char * data = ygeta_any(iarg, &ntot, dims, &typeid);
+  gint nc, width, height;
+
+  if (typeid != Y_CHAR) y_error("image must be of type char");
+  if (dims[0] == 3 && (dims[1] == 3 || dims[1] == 4)) {
+    nc = dims[1];
+    width = dims[2];
+    height = dims[3];
+    bytes = gy_bytes_get(iarg);
+  } else if (dims[0] == 2) {
+    // grey levels: expand to RGB
+    nc = 3;
+    width = dims[1];
+    height = dims[2];
+    guint8 * rgb = g_malloc(3*ntot);
+    for (i=0; i<ntot; ++i) rgb[3*i] = rgb[3*i+1] = rgb[3*i+2] = data[i];
+    bytes = g_bytes_new_take(rgb, 3*ntot);
+  } else
+    y_error("image must be char(3|4, width, height) or char(width, height)");
+
+  GObject * pixbuf = g_object_new(gtype,
+				  "colorspace", 0, // GDK_COLORSPACE_RGB
+				  "n-channels", nc,
+				  "has-alpha", nc == 4,
+				  "bits-per-sample", 8,
+				  "width", width,
+				  "height", height,
+				  "rowstride", nc*width,
+				  "pixel-bytes", bytes,
+				  NULL);
+  g_bytes_unref(bytes);
+
+  gy_Object * o = ypush_gy_Object();
+  o -> object = pixbuf;
+  o -> lazy = TRUE;
+}
+
+/* Push the pixels of PIXBUF as a char(nc, width, height) array. */
+static void
+gy_pixbuf_to_array(GObject * pixbuf)
+{
+  gint nc, width, height, rowstride, bps, y;
+  GBytes * bytes = NULL;
+  gpointer pixels = NULL;
+  gsize size = 0, row, need;
+  const guint8 * src;
+
+  g_object_get(pixbuf,
+	       "n-channels", &nc,
+	       "width", &width,
+	       "height", &height,
+	       "rowstride", &rowstride,
+	       "bits-per-sample", &bps,
+	       "pixel-bytes", &bytes,
+	       NULL);
+  if (bps != 8) {
+    if (bytes) g_bytes_unref(bytes);
+    y_error("only 8 bits per sample are supported");
+  }
+
+  row = nc*width;
+  // the last row is not padded
+  need = height > 0 ? (height-1)*(gsize)rowstride + row : 0;
+  if (bytes) src = g_bytes_get_data(bytes, &size);
+  else {
+    // pixbufs with pixel storage may not give their bytes
+    g_object_get(pixbuf, "pixels", &pixels, NULL);
+    src = pixels;
+    size = need;
+  }
+  if (!src || size < need || rowstride < row) {
+    if (bytes) g_bytes_unref(bytes);
+    y_error("could not read the pixels of the GdkPixbuf");
+  }
+  long dims[Y_DIMSIZE] = {3, nc, width, height};
+  guint8 * dst = (guint8*) ypush_c(dims);
+  if (rowstride == row) memcpy(dst, src, row*height);
+  else for (y=0; y<height; ++y) memcpy(dst+y*row, src+y*rowstride, row);
+  if (bytes) g_bytes_unref(bytes);
+}
+
+void
+Y_gy_pixbuf(int argc)
+{
+  if (argc != 1) y_error("gy_pixbuf takes exactly one argument");
+  if (yarg_gy_Object(0)) {
+    GObject * obj = yget_gy_Object(0)->object;
+    if (!obj || !G_TYPE_CHECK_INSTANCE_TYPE(obj, gy_pixbuf_type()))
+      y_error("object is not a GdkPixbuf");
+    gy_pixbuf_to_array(obj);
+  } else gy_pixbuf_from_array(0);
+}
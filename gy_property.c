@@ -19,90 +19,432 @@
 
 #include "gy.h"
 
-GIPropertyInfo *
-gy_base_info_find_property_info(GIBaseInfo * objectinfo, char * name)
-{
-
-  if (GI_IS_STRUCT_INFO(objectinfo)) return NULL;
-
-  gboolean isobject = GI_IS_OBJECT_INFO(objectinfo);
-  gint iprop, nprop = isobject?
-    g_object_info_get_n_properties(objectinfo):
-    g_interface_info_get_n_properties(objectinfo);
-
-  GIPropertyInfo * cur=NULL;
-  int hyphenize;
-  char * oname = NULL;
-  for (hyphenize=0; hyphenize<=1; ++hyphenize) {
-    if (hyphenize) {
-      GY_DEBUG("Property %s not found, trying to replace underscores with hyphens\n", name);
-      oname = p_strcpy(name);
-      g_strdelimit(name, "_", '-');
-      if (!strcmp(name, oname)) {
-	p_free(oname);
-	return NULL;
-      }
-    }
-	      
-    for (iprop=0; iprop<nprop; ++iprop) {
-      GY_DEBUG("i=%d/%d\n", iprop, nprop);
-      cur = isobject?
-	g_object_info_get_property (objectinfo, iprop):
-	g_interface_info_get_property (objectinfo, iprop);
-      GY_DEBUG("comparing %s with %s\n", name, g_base_info_get_name(cur));
-      if (!strcmp(name, g_base_info_get_name(cur))) {
-	GY_DEBUG("found it\n");
-	p_free(oname);
-	return cur;
-      }
+/// PROPERTIES
+
+/*
+  Each gy_Class holds an index of the properties of the class, its
+  ancestors and the interfaces they implement. Both the hyphen (C)
+  and underscore (Yorick) spellings of a property name map to the same
+  gy_Property record, which caches everything needed to get or set
+  the property.
+ */
+
+static GParamSpec *
+gy_Property_find_pspec(gpointer gclass, GIBaseInfo * declarer,
+		       const gchar * name)
+{
+  GParamSpec * pspec = NULL;
+  if (gclass) {
+    if (G_TYPE_IS_INTERFACE(((GTypeInterface*)gclass)->g_type))
+      pspec = g_object_interface_find_property(gclass, name);
+    else
+      pspec = g_object_class_find_property(G_OBJECT_CLASS(gclass), name);
+  }
+  if (!pspec && GI_IS_INTERFACE_INFO(declarer)) {
+    // kept for the session, like the tables which point to it
+    gpointer iface =
+      g_type_default_interface_ref(g_registered_type_info_get_g_type(declarer));
+    pspec = g_object_interface_find_property(iface, name);
+  }
+  return pspec;
+}
+
+static void
+gy_Class_add_properties(GHashTable * tbl, gpointer gclass, GIBaseInfo * info)
+{
+  gboolean isobject = GI_IS_OBJECT_INFO(info);
+  gint i, n = isobject?
+    g_object_info_get_n_properties(info):
+    g_interface_info_get_n_properties(info);
+  GIPropertyInfo * cur;
+  gy_Property * prop;
+  const gchar * name;
+
+  for (i=0; i<n; ++i) {
+    cur = isobject?
+      g_object_info_get_property (info, i):
+      g_interface_info_get_property (info, i);
+    name = g_intern_string(g_base_info_get_name(cur));
+    if (g_hash_table_lookup(tbl, name)) {
       g_base_info_unref(cur);
+      continue;
+    }
+    prop = g_new0(gy_Property, 1);
+    prop -> info  = cur;
+    prop -> name  = name;
+    prop -> type  = g_property_info_get_type(cur);
+    prop -> flags = g_property_info_get_flags(cur);
+    prop -> pspec = gy_Property_find_pspec(gclass, info, name);
+    prop -> value_type = prop->pspec ? prop->pspec->value_type : G_TYPE_INVALID;
+    if (prop->value_type != G_TYPE_INVALID)
+      prop -> conv = gy_value_conv_for(prop->value_type);
+    g_hash_table_insert(tbl, (gpointer) name, prop);
+
+    if (strchr(name, '-')) {
+      gchar * uname = g_strdelimit(g_strdup(name), "-", '_');
+      const gchar * iname = g_intern_string(uname);
+      g_free(uname);
+      if (!g_hash_table_lookup(tbl, iname))
+	g_hash_table_insert(tbl, (gpointer) iname, prop);
     }
   }
-  strcpy(name, oname);
-  p_free(oname);
-  return NULL;
 }
 
-GIPropertyInfo *
-gy_base_info_find_field_info(GIBaseInfo * objectinfo, char * name)
+static void
+gy_Class_build_properties(gy_Class * klass)
 {
+  GHashTable * tbl = g_hash_table_new(g_str_hash, g_str_equal);
+  GIBaseInfo * cur, * next;
+  gpointer gclass = NULL;
+  gint i, n;
+
+  // The class (or interface vtable) reference is never dropped: the
+  // GParamSpecs cached in the index belong to it.
+  if (klass->gtype != G_TYPE_NONE && klass->gtype != G_TYPE_INVALID) {
+    if (G_TYPE_IS_INTERFACE(klass->gtype))
+      gclass = g_type_default_interface_ref(klass->gtype);
+    else if (g_type_is_a(klass->gtype, G_TYPE_OBJECT))
+      gclass = g_type_class_ref(klass->gtype);
+  }
 
-  if (GI_IS_INTERFACE_INFO(objectinfo)) return NULL;
+  if (GI_IS_INTERFACE_INFO(klass->info)) {
+    gy_Class_add_properties(tbl, gclass, klass->info);
+    klass -> properties = tbl;
+    return;
+  }
 
-  gboolean isobject = GI_IS_OBJECT_INFO(objectinfo);
-  gint iprop, nprop = isobject?
-    g_object_info_get_n_fields(objectinfo):
-    g_struct_info_get_n_fields(objectinfo);
+  if (!GI_IS_OBJECT_INFO(klass->info)) {
+    klass -> properties = tbl;
+    return;
+  }
 
-  GIFieldInfo * cur=NULL;
-  int hyphenize;
-  char * oname = NULL;
-  for (hyphenize=0; hyphenize<=1; ++hyphenize) {
-    if (hyphenize) {
-      GY_DEBUG("Field %s not found, trying to replace underscores with hyphens\n", name);
-      oname = p_strcpy(name);
-      g_strdelimit(name, "_", '-');
-      if (!strcmp(name, oname)) {
-	p_free(oname);
-	return NULL;
-      }
+  cur = g_base_info_ref(klass->info);
+  while (cur) {
+    gy_Class_add_properties(tbl, gclass, cur);
+    next = g_object_info_get_parent(cur);
+    g_base_info_unref(cur);
+    cur = next;
+  }
+
+  cur = g_base_info_ref(klass->info);
+  while (cur) {
+    n = g_object_info_get_n_interfaces(cur);
+    for (i=0; i<n; ++i) {
+      GIInterfaceInfo * itrf = g_object_info_get_interface(cur, i);
+      gy_Class_add_properties(tbl, gclass, itrf);
+      g_base_info_unref(itrf);
     }
-	      
-    for (iprop=0; iprop<nprop; ++iprop) {
-      GY_DEBUG("i=%d/%d\n", iprop, nprop);
-      cur = isobject?
-	g_object_info_get_field (objectinfo, iprop):
-	g_struct_info_get_field (objectinfo, iprop);
-      GY_DEBUG("comparing %s with %s\n", name, g_base_info_get_name(cur));
-      if (!strcmp(name, g_base_info_get_name(cur))) {
-	GY_DEBUG("found it\n");
-	p_free(oname);
-	return cur;
-      }
+    next = g_object_info_get_parent(cur);
+    g_base_info_unref(cur);
+    cur = next;
+  }
+
+  klass -> properties = tbl;
+}
+
+gy_Property *
+gy_Class_find_property(gy_Class * klass, const char * name)
+{
+  if (!klass->properties) gy_Class_build_properties(klass);
+  return g_hash_table_lookup(klass->properties, name);
+}
+
+void
+gy_Property_value_init(gy_Property * prop, GValue * val)
+{
+  if (prop->value_type != G_TYPE_INVALID)
+    g_value_init(val, prop->value_type);
+  else
+    gy_value_init(val, prop->type);
+}
+
+void
+gy_Property_value_set(gy_Property * prop, GValue * val, int iarg)
+{
+  if (prop->conv) prop->conv->set(prop->conv, val, iarg);
+  else gy_value_set_iarg(val, prop->type, iarg);
+}
+
+void
+gy_Property_value_push(gy_Property * prop, GValue * val, gy_Object * o)
+{
+  if (prop->conv) prop->conv->push(prop->conv, val, o);
+  else gy_value_push(val, prop->type, o);
+}
+
+/// BATCHES
+
+/*
+  All the properties set or read in one Yorick call (obj, a=1, b=2,
+  "c", var) are collected in a batch, a scratch object on the Yorick
+  stack, and applied at once: the setters with one g_object_setv
+  between g_object_freeze_notify and g_object_thaw_notify, so that
+  "notify" is emitted in one burst after all values are in place, and
+  then the getters with one g_object_getv. Dropping the batch, even
+  after an error, unsets the values and thaws notifications.
+ */
+
+struct _gy_PropBatch {
+  GObject * object;
+  gboolean frozen;
+  guint n_set;
+  const gchar ** set_names;
+  GValue * set_values;
+  guint n_get;
+  gy_Property ** get_props;
+  long * get_idx;        // output variables
+  const gchar ** get_names;
+  GValue * get_values;
+};
+
+static void
+gy_PropBatch_free(void * data)
+{
+  gy_PropBatch * batch = data;
+  guint i;
+  if (batch->frozen) g_object_thaw_notify(batch->object);
+  for (i=0; i<batch->n_set; ++i)
+    if (G_IS_VALUE(batch->set_values+i)) g_value_unset(batch->set_values+i);
+  for (i=0; i<batch->n_get; ++i)
+    if (G_IS_VALUE(batch->get_values+i)) g_value_unset(batch->get_values+i);
+  g_free(batch->set_names);
+  g_free(batch->set_values);
+  g_free(batch->get_props);
+  g_free(batch->get_idx);
+  g_free(batch->get_names);
+  g_free(batch->get_values);
+}
+
+/* Push a batch for at most MAX setters and MAX getters on OBJECT. */
+gy_PropBatch *
+gy_PropBatch_push(GObject * object, guint max)
+{
+  gy_PropBatch * batch = ypush_scratch(sizeof(gy_PropBatch),
+				       &gy_PropBatch_free);
+  batch -> object     = object;
+  batch -> frozen     = FALSE;
+  batch -> n_set      = 0;
+  batch -> set_names  = g_new0(const gchar *, max);
+  batch -> set_values = g_new0(GValue, max);
+  batch -> n_get      = 0;
+  batch -> get_props  = g_new0(gy_Property *, max);
+  batch -> get_idx    = g_new0(long, max);
+  batch -> get_names  = g_new0(const gchar *, max);
+  batch -> get_values = g_new0(GValue, max);
+  return batch;
+}
+
+/* Convert argument IARG for property PROP. */
+void
+gy_PropBatch_set(gy_PropBatch * batch, gy_Property * prop, int iarg)
+{
+  GValue * val = batch->set_values + batch->n_set;
+  if (!(prop->flags & G_PARAM_WRITABLE))
+    y_errorq("property %s is not writable", prop->name);
+  batch -> set_names[batch->n_set++] = prop->name;
+  gy_Property_value_init(prop, val);
+  gy_Property_value_set(prop, val, iarg);
+}
+
+/* Read property PROP into global variable IDX when applying. */
+void
+gy_PropBatch_get(gy_PropBatch * batch, gy_Property * prop, long idx)
+{
+  if (!(prop->flags & G_PARAM_READABLE))
+    y_errorq("property %s is not readable", prop->name);
+  batch -> get_props[batch->n_get] = prop;
+  batch -> get_idx[batch->n_get] = idx;
+  batch -> get_names[batch->n_get++] = prop->name;
+}
+
+void
+gy_PropBatch_apply(gy_PropBatch * batch, gy_Object * o)
+{
+  guint i;
+
+  if (batch->n_set) {
+    g_object_freeze_notify(batch->object);
+    batch -> frozen = TRUE;
+#if GLIB_CHECK_VERSION(2,54,0)
+    g_object_setv(batch->object, batch->n_set,
+		  batch->set_names, batch->set_values);
+#else
+    for (i=0; i<batch->n_set; ++i)
+      g_object_set_property(batch->object, batch->set_names[i],
+			    batch->set_values+i);
+#endif
+    batch -> frozen = FALSE;
+    g_object_thaw_notify(batch->object);
+  }
+
+  if (!batch->n_get) return;
+#if GLIB_CHECK_VERSION(2,54,0)
+  // g_object_getv initializes the values to the type of the pspecs
+  g_object_getv(batch->object, batch->n_get,
+		batch->get_names, batch->get_values);
+#else
+  for (i=0; i<batch->n_get; ++i) {
+    gy_Property_value_init(batch->get_props[i], batch->get_values+i);
+    g_object_get_property(batch->object, batch->get_names[i],
+			  batch->get_values+i);
+  }
+#endif
+  for (i=0; i<batch->n_get; ++i) {
+    if (!G_IS_VALUE(batch->get_values+i))
+      y_errorq("could not get property %s", batch->get_names[i]);
+    gy_Property_value_push(batch->get_props[i], batch->get_values+i, o);
+    yput_global(batch->get_idx[i], 0);
+    yarg_drop(1);
+  }
+}
+
+/// FIELDS
+
+/*
+  Field layouts are computed once per class: offset, type tag and, for
+  basic types (including enums, through their storage type), the size
+  of the value, so that reading a field is a direct typed load from
+  the structure memory.
+ */
+
+static GITypeTag
+gy_Field_direct_tag(GIFieldInfo * info, GITypeInfo * type, gint * size)
+{
+  GITypeTag tag = g_type_info_get_tag(type);
+  *size = 0;
+
+  // pointers and bit fields go through g_field_info_get_field
+  if (g_type_info_is_pointer(type) || g_field_info_get_size(info))
+    return GI_TYPE_TAG_VOID;
+
+  if (tag == GI_TYPE_TAG_INTERFACE) {
+    GIBaseInfo * itrf = g_type_info_get_interface(type);
+    GIInfoType itype = g_base_info_get_type(itrf);
+    if (itype == GI_INFO_TYPE_ENUM || itype == GI_INFO_TYPE_FLAGS)
+      tag = g_enum_info_get_storage_type(itrf);
+    g_base_info_unref(itrf);
+  }
+
+  switch (tag) {
+  case GI_TYPE_TAG_BOOLEAN: *size = sizeof(gboolean); break;
+  case GI_TYPE_TAG_INT8:
+  case GI_TYPE_TAG_UINT8:   *size = 1; break;
+  case GI_TYPE_TAG_INT16:
+  case GI_TYPE_TAG_UINT16:  *size = 2; break;
+  case GI_TYPE_TAG_INT32:
+  case GI_TYPE_TAG_UINT32:  *size = 4; break;
+  case GI_TYPE_TAG_INT64:
+  case GI_TYPE_TAG_UINT64:  *size = 8; break;
+  case GI_TYPE_TAG_FLOAT:   *size = sizeof(gfloat); break;
+  case GI_TYPE_TAG_DOUBLE:  *size = sizeof(gdouble); break;
+  case GI_TYPE_TAG_GTYPE:   *size = sizeof(GType); break;
+  default:
+    return GI_TYPE_TAG_VOID;
+  }
+  return tag;
+}
+
+static void
+gy_Class_build_fields(gy_Class * klass)
+{
+  GHashTable * tbl = g_hash_table_new(g_str_hash, g_str_equal);
+  gboolean isobject = GI_IS_OBJECT_INFO(klass->info);
+  gint i, n = 0;
+  GIFieldInfo * cur;
+  gy_Field * field;
+  const gchar * name;
+
+  if (isobject) n = g_object_info_get_n_fields(klass->info);
+  else if (GI_IS_STRUCT_INFO(klass->info))
+    n = g_struct_info_get_n_fields(klass->info);
+
+  for (i=0; i<n; ++i) {
+    cur = isobject?
+      g_object_info_get_field (klass->info, i):
+      g_struct_info_get_field (klass->info, i);
+    name = g_intern_string(g_base_info_get_name(cur));
+    if (g_hash_table_lookup(tbl, name)) {
       g_base_info_unref(cur);
+      continue;
+    }
+    field = g_new0(gy_Field, 1);
+    field -> info   = cur;
+    field -> name   = name;
+    field -> type   = g_field_info_get_type(cur);
+    field -> flags  = g_field_info_get_flags(cur);
+    field -> offset = g_field_info_get_offset(cur);
+    field -> tag    = gy_Field_direct_tag(cur, field->type, &field->size);
+    g_hash_table_insert(tbl, (gpointer) name, field);
+
+    if (strchr(name, '-')) {
+      gchar * uname = g_strdelimit(g_strdup(name), "-", '_');
+      const gchar * iname = g_intern_string(uname);
+      g_free(uname);
+      if (!g_hash_table_lookup(tbl, iname))
+	g_hash_table_insert(tbl, (gpointer) iname, field);
     }
   }
-  strcpy(name, oname);
-  p_free(oname);
-  return NULL;
+
+  klass -> fields = tbl;
+}
+
+gy_Field *
+gy_Class_find_field(gy_Class * klass, const char * name)
+{
+  if (!klass->fields) gy_Class_build_fields(klass);
+  return g_hash_table_lookup(klass->fields, name);
+}
+
+void
+gy_Field_push(gy_Field * field, gpointer mem, gy_Object * o)
+{
+  if (!mem) y_error("Object is NULL");
+  if (!(field->flags & GI_FIELD_IS_READABLE)) y_error("get field failed");
+
+  gpointer p = G_STRUCT_MEMBER_P(mem, field->offset);
+
+  switch (field->tag) {
+  case GI_TYPE_TAG_BOOLEAN:
+    ypush_long(*(gboolean*)p);
+    break;
+  case GI_TYPE_TAG_INT8:
+    ypush_long(*(gint8*)p);
+    break;
+  case GI_TYPE_TAG_UINT8:
+    ypush_long(*(guint8*)p);
+    break;
+  case GI_TYPE_TAG_INT16:
+    ypush_long(*(gint16*)p);
+    break;
+  case GI_TYPE_TAG_UINT16:
+    ypush_long(*(guint16*)p);
+    break;
+  case GI_TYPE_TAG_INT32:
+    ypush_long(*(gint32*)p);
+    break;
+  case GI_TYPE_TAG_UINT32:
+    ypush_long(*(guint32*)p);
+    break;
+  case GI_TYPE_TAG_INT64:
+    ypush_long(*(gint64*)p);
+    break;
+  case GI_TYPE_TAG_UINT64:
+    ypush_long(*(guint64*)p);
+    break;
+  case GI_TYPE_TAG_FLOAT:
+    ypush_double(*(gfloat*)p);
+    break;
+  case GI_TYPE_TAG_DOUBLE:
+    ypush_double(*(gdouble*)p);
+    break;
+  case GI_TYPE_TAG_GTYPE:
+    ypush_long(*(GType*)p);
+    break;
+  default: {
+    GIArgument rarg;
+    if (!g_field_info_get_field(field->info, mem, &rarg))
+      y_error("get field failed");
+    gy_Argument_pushany(&rarg, field->type, o);
+  }
+  }
 }
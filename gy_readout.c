@@ -0,0 +1,313 @@
+/*
+    Copyright 2013 Thibaut Paumard
+
+    This file is part of gy (GObject Introspection for Yorick).
+
+    Gyoto is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gyoto is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gy.h"
+#include <math.h>
+
+/// READOUT
+
+/*
+  Mouse readout for Yorick windows embedded in a Gtk.DrawingArea (see
+  gy_gtk_ywindow in gy_gtk.i). The engine attached to the drawing area
+  caches the viewport and limits of the Yorick window. Yorick refreshes
+  them where they may have changed: when the pointer is grabbed, on
+  button events, after a zoom or a mouse_handler. Limits changed from
+  the prompt while the pointer is in the window show up at the next
+  button event or when the pointer enters the window again.
+
+  Motion events are handled entirely in C, by a handler connected to
+  "event" ahead of the interpreted one. The position is converted to
+  world coordinates, and a label is set only when its text changes.
+  Yorick still gets the events the engine does not handle: buttons
+  (zoom or mouse_handler), motion outside the visible part of the
+  window, and everything else. It uses the same transform and zoom
+  code through gy_gtk_readout_coords and gy_gtk_readout_zoom.
+
+  Gtk is reached through GObject properties. The layout of the events
+  comes from the typelib, so gy does not link with Gtk.
+ */
+
+#define GY_READOUT_LEN 32
+
+typedef struct _gy_Readout {
+  GObject * label[3];    // system, x and y labels, may be NULL
+  gchar text[3][GY_READOUT_LEN]; // their current text
+  GObject * hadj, * vadj; // scrolling of the drawing area
+  gdouble pix2ndc;
+  gdouble vp[4];         // viewport()
+  gdouble lm[4];         // limits()(1:4)
+  glong flags;           // limits()(5)
+  gboolean valid;        // vp and lm are up to date, handle motion
+} gy_Readout;
+
+static const gchar * gy_readout_key = "gy-readout";
+
+// GdkEventMotion layout
+static gboolean gy_readout_ev_init = FALSE;
+static gint gy_readout_ev_motion;
+static gint gy_readout_ev_x, gy_readout_ev_y;
+
+static void
+gy_readout_init_events(void)
+{
+  GIBaseInfo * info;
+  gy_Field * fx, * fy;
+  gint64 motion;
+  GError * err = NULL;
+
+  if (gy_readout_ev_init) return;
+  if (!g_irepository_require(NULL, "Gdk", NULL, 0, &err))
+    y_error(err->message);
+
+  info = g_irepository_find_by_name(NULL, "Gdk", "EventType");
+  if (!info) y_error("Gdk.EventType not found");
+  if (!gy_Class_find_value(gy_Class_get(info), "motion_notify", &motion))
+    y_error("Gdk.EventType.motion_notify not found");
+
+  info = g_irepository_find_by_name(NULL, "Gdk", "EventMotion");
+  if (!info) y_error("Gdk.EventMotion not found");
+  fx = gy_Class_find_field(gy_Class_get(info), "x");
+  fy = gy_Class_find_field(gy_Class_get(info), "y");
+  if (!fx || !fy || fx->tag != GI_TYPE_TAG_DOUBLE ||
+      fy->tag != GI_TYPE_TAG_DOUBLE)
+    y_error("unexpected layout of Gdk.EventMotion");
+
+  gy_readout_ev_motion = motion;
+  gy_readout_ev_x = fx->offset;
+  gy_readout_ev_y = fy->offset;
+  gy_readout_ev_init = TRUE;
+}
+
+static void
+gy_readout_free(gpointer data)
+{
+  gy_Readout * r = data;
+  gint i;
+  for (i=0; i<3; ++i) if (r->label[i]) g_object_unref(r->label[i]);
+  if (r->hadj) g_object_unref(r->hadj);
+  if (r->vadj) g_object_unref(r->vadj);
+  g_free(r);
+}
+
+/* Replace *DEST with a reference on object argument IARG (nil: NULL). */
+static void
+gy_readout_set_object(GObject ** dest, int iarg)
+{
+  GObject * obj = yarg_nil(iarg) ? NULL : yget_gy_Object(iarg)->object;
+  if (obj) g_object_ref(obj);
+  if (*dest) g_object_unref(*dest);
+  *dest = obj;
+}
+
+/* Set label I to TEXT, unless it already shows it. */
+static void
+gy_readout_label(gy_Readout * r, gint i, const gchar * text)
+{
+  if (!r->label[i] || !strcmp(r->text[i], text)) return;
+  g_strlcpy(r->text[i], text, GY_READOUT_LEN);
+  g_object_set(r->label[i], "label", text, NULL);
+}
+
+static void
+gy_readout_show(gy_Readout * r, const gchar * sys, gdouble xs, gdouble ys)
+{
+  gchar buf[GY_READOUT_LEN];
+  gy_readout_label(r, 0, sys);
+  g_snprintf(buf, GY_READOUT_LEN, "%g", xs);
+  gy_readout_label(r, 1, buf);
+  g_snprintf(buf, GY_READOUT_LEN, "%g", ys);
+  gy_readout_label(r, 2, buf);
+}
+
+/* World coordinate along one axis of normalized device coordinate
+   NDC, given the viewport VP and limits LM of this axis. */
+static gdouble
+gy_readout_axis(gdouble ndc, const gdouble * vp, const gdouble * lm,
+		gboolean logscale)
+{
+  gdouble f;
+  if (ndc < vp[0]) return lm[0];
+  if (ndc > vp[1]) return lm[1];
+  f = (ndc-vp[0])/(vp[1]-vp[0]);
+  return logscale ? lm[0]*pow(lm[1]/lm[0], f) : lm[0]+f*(lm[1]-lm[0]);
+}
+
+/* World coordinates of pixel (X, Y) of the drawing area. */
+static void
+gy_readout_world(gy_Readout * r, gdouble x, gdouble y,
+		 gdouble * xs, gdouble * ys)
+{
+  gdouble xndc = r->pix2ndc*(x-2);
+  gdouble yndc = 11.*72.27*0.0013 - r->pix2ndc*(y-1);
+  *xs = gy_readout_axis(xndc, r->vp, r->lm, r->flags & 128);
+  *ys = gy_readout_axis(yndc, r->vp+2, r->lm+2, r->flags & 256);
+}
+
+/* Whether POS is within the visible part of ADJ. */
+static gboolean
+gy_readout_visible(GObject * adj, gdouble pos)
+{
+  gdouble value, page;
+  if (!adj) return TRUE;
+  g_object_get(adj, "value", &value, "page-size", &page, NULL);
+  return pos >= value && pos <= value+page;
+}
+
+static gboolean
+gy_readout_event(GObject * widget, gpointer event, gpointer data)
+{
+  gy_Readout * r = data;
+  gdouble x, y, xs, ys;
+
+  if (!r->valid || *(gint*)event != gy_readout_ev_motion) return FALSE;
+  x = G_STRUCT_MEMBER(gdouble, event, gy_readout_ev_x);
+  y = G_STRUCT_MEMBER(gdouble, event, gy_readout_ev_y);
+  // leaving the visible part: let Yorick release the pointer
+  if (!gy_readout_visible(r->hadj, x) || !gy_readout_visible(r->vadj, y))
+    return FALSE;
+  gy_readout_world(r, x, y, &xs, &ys);
+  gy_readout_show(r, "?", xs, ys);
+  return TRUE;
+}
+
+static gy_Readout *
+gy_readout_get(int iarg)
+{
+  GObject * da = yget_gy_Object(iarg)->object;
+  gy_Readout * r = da ? g_object_get_data(da, gy_readout_key) : NULL;
+  if (!r) y_error("no readout attached to this widget (see gy_gtk_readout)");
+  return r;
+}
+
+void
+Y_gy_gtk_readout(int argc)
+{
+  GObject * da;
+  gy_Readout * r;
+  gint i;
+
+  if (argc != 5) y_error("gy_gtk_readout takes exactly 5 arguments");
+  da = yget_gy_Object(argc-1)->object;
+  if (!G_IS_OBJECT(da)) y_error("expecting a Gtk.DrawingArea");
+  gdouble dpi = ygets_d(0);
+  if (dpi <= 0) y_error("dpi must be > 0");
+
+  if (!(r = g_object_get_data(da, gy_readout_key))) {
+    gy_readout_init_events();
+    r = g_new0(gy_Readout, 1);
+    g_object_set_data_full(da, gy_readout_key, r, &gy_readout_free);
+    g_signal_connect(da, "event", G_CALLBACK(&gy_readout_event), r);
+  }
+  for (i=0; i<3; ++i) {
+    gy_readout_set_object(r->label+i, argc-2-i);
+    r -> text[i][0] = '\0';
+  }
+  r -> pix2ndc = 72.27/dpi*0.0013;
+  r -> valid = FALSE;
+  ypush_nil();
+}
+
+void
+Y_gy_gtk_readout_limits(int argc)
+{
+  long ntot;
+  double * vp, * lm;
+
+  if (argc != 1 && argc != 5)
+    y_error("gy_gtk_readout_limits takes 1 or 5 arguments");
+  gy_Readout * r = gy_readout_get(argc-1);
+  if (argc == 1) {
+    r -> valid = FALSE;
+    ypush_nil();
+    return;
+  }
+  vp = ygeta_d(argc-2, &ntot, NULL);
+  if (ntot != 4) y_error("viewport must have 4 elements");
+  lm = ygeta_d(argc-3, &ntot, NULL);
+  if (ntot != 5) y_error("limits must have 5 elements");
+  memcpy(r->vp, vp, sizeof(r->vp));
+  memcpy(r->lm, lm, sizeof(r->lm));
+  r -> flags = lm[4];
+  gy_readout_set_object(&r->hadj, argc-4);
+  gy_readout_set_object(&r->vadj, argc-5);
+  r -> valid = TRUE;
+  ypush_nil();
+}
+
+void
+Y_gy_gtk_readout_coords(int argc)
+{
+  long dims[Y_DIMSIZE] = {1, 2};
+  double * res;
+
+  if (argc != 3) y_error("gy_gtk_readout_coords takes exactly 3 arguments");
+  gy_Readout * r = gy_readout_get(argc-1);
+  if (!r->valid) y_error("readout limits not set");
+  gdouble x = ygets_d(argc-2), y = ygets_d(argc-3);
+  res = ypush_d(dims);
+  gy_readout_world(r, x, y, res, res+1);
+}
+
+void
+Y_gy_gtk_readout_zoom(int argc)
+{
+  long dims[Y_DIMSIZE] = {1, 6};
+  double s0[2], s[2], fact = 1., * res;
+  gint a;
+
+  if (argc != 6) y_error("gy_gtk_readout_zoom takes exactly 6 arguments");
+  gy_Readout * r = gy_readout_get(argc-1);
+  if (!r->valid) y_error("readout limits not set");
+  s0[0] = ygets_d(argc-2);
+  s0[1] = ygets_d(argc-3);
+  s[0]  = ygets_d(argc-4);
+  s[1]  = ygets_d(argc-5);
+  long button = ygets_l(argc-6);
+  if (button == 1) fact = 2./3.;
+  else if (button == 3) fact = 1.5;
+
+  res = ypush_d(dims);
+  memcpy(res, r->lm, sizeof(r->lm));
+  res[4] = res[5] = 0.;  // whether each axis changed
+  for (a=0; a<2; ++a) {
+    const gdouble * lm = r->lm + 2*a;
+    // the press was clamped to the border: leave this axis alone
+    if (s0[a] == lm[0] || s0[a] == lm[1]) continue;
+    if (r->flags & (a ? 256 : 128)) {
+      res[2*a]   = s0[a] / pow(s[a]/lm[0], fact);
+      res[2*a+1] = s0[a] / pow(s[a]/lm[1], fact);
+    } else {
+      res[2*a]   = s0[a] - (s[a]-lm[0])*fact;
+      res[2*a+1] = s0[a] - (s[a]-lm[1])*fact;
+    }
+    res[4+a] = 1.;
+  }
+}
+
+void
+Y_gy_gtk_readout_show(int argc)
+{
+  gchar sys[GY_READOUT_LEN];
+  if (argc != 4) y_error("gy_gtk_readout_show takes exactly 4 arguments");
+  gy_Readout * r = gy_readout_get(argc-1);
+  if (yarg_string(0)) g_strlcpy(sys, ygets_q(0), GY_READOUT_LEN);
+  else g_snprintf(sys, GY_READOUT_LEN, "%ld", ygets_l(0));
+  gy_readout_show(r, sys, ygets_d(argc-2), ygets_d(argc-3));
+  ypush_nil();
+}
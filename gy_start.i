@@ -1,5 +1,6 @@
 autoload, "gy.i";
 autoload, "gy.i", gy, gy_init, gy_list, gy_i, gy_debug, gy_setlocale;
+autoload, "gy.i", gy_variant_get, gy_variant_put;
 autoload, "gy_gtk.i";
 autoload, "gy_gtk.i", gy_gtk_i;
 autoload, "gy_gtk.i", gyterm, gycmap, gywindow, gyerror;
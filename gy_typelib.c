@@ -41,10 +41,33 @@ void gy_Typelib_print(void *obj){
 }
 
 
+/*
+  Members already extracted from a namespace are cached, per typelib,
+  as Yorick values: constants already converted, types as a shared
+  gy_Object prototype. Further accesses don't touch the repository.
+ */
+static GHashTable * gy_Typelib_members = NULL;
+
 void
 gy_Typelib_extract(void *obj, char * name)
 {
   gy_Typelib * tl = (gy_Typelib *) obj;
+  GHashTable * members;
+  void * use;
+
+  if (!gy_Typelib_members)
+    gy_Typelib_members = g_hash_table_new(NULL, NULL);
+  members = g_hash_table_lookup(gy_Typelib_members, tl->typelib);
+  if (!members) {
+    members = g_hash_table_new(g_str_hash, g_str_equal);
+    g_hash_table_insert(gy_Typelib_members, tl->typelib, members);
+  }
+  use = g_hash_table_lookup(members, name);
+  if (use) {
+    ypush_use(use);
+    return;
+  }
+
   GIBaseInfo * info = g_irepository_find_by_name(tl->repo,
 						 tl->namespace,
 						 name);
@@ -60,11 +83,16 @@ gy_Typelib_extract(void *obj, char * name)
     GITypeInfo * retinfo = g_constant_info_get_type(o->info);
     //gint retval = // useless so far: size of the constant
     g_constant_info_get_value(o->info, &rarg);
-    yarg_drop(1);
     gy_Argument_pushany(&rarg, retinfo, o);
+    g_constant_info_free_value(o->info, &rarg);
     g_base_info_unref(retinfo);
+    // drop the wrapper only now, gy_Argument_pushany may use it
+    yarg_swap(0, 1);
+    yarg_drop(1);
   }
 
+  g_hash_table_insert(members, (gpointer) g_intern_string(name),
+		      yget_use(0));
 }
 
 gy_Typelib* yget_gy_Typelib(int iarg) {
@@ -0,0 +1,276 @@
+/*
+    Copyright 2013 Thibaut Paumard
+
+    This file is part of gy (GObject Introspection for Yorick).
+
+    Gyoto is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gyoto is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gy.h"
+
+/// GVARIANT
+
+/*
+  Basic values and arrays of them are converted to and from Yorick
+  values. Numeric arrays become GVariants wrapping the Yorick array
+  memory (through gy_bytes_get), so that no copy is made; the other
+  way round the data is copied once, Yorick arrays owning their
+  memory. Other values (tuples, dictionaries, variants...) are
+  handed to Yorick as GLib.Variant objects; gy_variant_get in gy.i
+  turns them into oxy objects.
+ */
+
+gboolean
+gy_type_is_variant(GITypeInfo * info)
+{
+  GIBaseInfo * itrf;
+  gboolean res = 0;
+  if (g_type_info_get_tag(info) != GI_TYPE_TAG_INTERFACE) return 0;
+  itrf = g_type_info_get_interface(info);
+  if (GI_IS_STRUCT_INFO(itrf))
+    res = g_registered_type_info_get_g_type(itrf) == G_TYPE_VARIANT;
+  g_base_info_unref(itrf);
+  return res;
+}
+
+/* Push a GLib.Variant object holding a reference on V. */
+static void
+gy_variant_push_object(GVariant * v)
+{
+  GIBaseInfo * info = gy_glib_info(G_TYPE_VARIANT);
+  gy_Object * o = ypush_gy_Object();
+  o -> object = (GObject*) g_variant_ref_sink(v);
+  o -> boxed = G_TYPE_VARIANT;
+  if (info) o -> info = g_base_info_ref(info);
+}
+
+/* Type of the Yorick arrays holding elements of basic type C. */
+static int
+gy_variant_typeid(gchar c)
+{
+  switch (c) {
+  case 'b': case 'y':           return Y_CHAR;
+  case 'n': case 'q':           return Y_SHORT;
+  case 'i': case 'u': case 'h': return Y_INT;
+  case 'x': case 't':           return Y_LONG;
+  case 'd':                     return Y_DOUBLE;
+  default:                      return -1;
+  }
+}
+
+/* Basic type of the GVariants holding Yorick values of type TYPEID. */
+static gchar
+gy_variant_natural(int typeid)
+{
+  switch (typeid) {
+  case Y_CHAR:   return 'y';
+  case Y_SHORT:  return 'n';
+  case Y_INT:    return 'i';
+  case Y_LONG:   return 'x';
+  case Y_FLOAT:
+  case Y_DOUBLE: return 'd';
+  default:       return 0;
+  }
+}
+
+void
+gy_variant_push(GVariant * v)
+{
+  const gchar * type = g_variant_get_type_string(v);
+  gsize n;
+  long dims[Y_DIMSIZE] = {1, 0};
+
+  switch (type[0]) {
+  case 'b': ypush_long(g_variant_get_boolean(v)); return;
+  case 'y': *ypush_c(0) = g_variant_get_byte(v); return;
+  case 'n': ypush_long(g_variant_get_int16(v)); return;
+  case 'q': ypush_long(g_variant_get_uint16(v)); return;
+  case 'i': ypush_int(g_variant_get_int32(v)); return;
+  case 'u': ypush_long(g_variant_get_uint32(v)); return;
+  case 'h': ypush_int(g_variant_get_handle(v)); return;
+  case 'x': ypush_long(g_variant_get_int64(v)); return;
+  case 't': ypush_long(g_variant_get_uint64(v)); return;
+  case 'd': ypush_double(g_variant_get_double(v)); return;
+  case 's':
+  case 'o':
+  case 'g':
+    *ypush_q(0) = p_strcpy(g_variant_get_string(v, NULL));
+    return;
+  case 'a':
+    if (type[2]) break;
+    if (type[1] == 's' || type[1] == 'o' || type[1] == 'g') {
+      if (!(n = g_variant_n_children(v))) {
+	ypush_nil();
+	return;
+      }
+      dims[1] = n;
+      ystring_t * res = ypush_q(dims);
+      gsize i;
+      for (i=0; i<n; ++i) {
+	GVariant * child = g_variant_get_child_value(v, i);
+	res[i] = p_strcpy(g_variant_get_string(child, NULL));
+	g_variant_unref(child);
+      }
+      return;
+    }
+    if (gy_variant_typeid(type[1]) >= 0) {
+      gsize sz = type[1]=='b' || type[1]=='y' ? 1 :
+	(type[1]=='n' || type[1]=='q') ? 2 :
+	(type[1]=='i' || type[1]=='u' || type[1]=='h') ? 4 : 8;
+      gconstpointer data = g_variant_get_fixed_array(v, &n, sz);
+      if (!n) {
+	ypush_nil();
+	return;
+      }
+      dims[1] = n;
+      switch (gy_variant_typeid(type[1])) {
+      case Y_CHAR:  memcpy(ypush_c(dims), data, n*sz); break;
+      case Y_SHORT: memcpy(ypush_s(dims), data, n*sz); break;
+      case Y_INT:   memcpy(ypush_i(dims), data, n*sz); break;
+      case Y_LONG:  memcpy(ypush_l(dims), data, n*sz); break;
+      default:      memcpy(ypush_d(dims), data, n*sz);
+      }
+      return;
+    }
+    break;
+  default:
+    break;
+  }
+  gy_variant_push_object(v);
+}
+
+/* GVariant of type TYPE (if not NULL) holding argument IARG. Values
+   created here are floating; GLib.Variant objects are passed as
+   is. */
+GVariant *
+gy_variant_get(int iarg, const gchar * type)
+{
+  char buf[3] = {0};
+  GError * err = NULL;
+  GVariant * v;
+  long ntot;
+  int typeid, rank;
+
+  if (yarg_gy_Object(iarg)) {
+    gy_Object * o = yget_gy_Object(iarg);
+    if (o->boxed != G_TYPE_VARIANT || !o->object)
+      y_error("expecting a GLib.Variant");
+    v = (GVariant*) o->object;
+    if (type && type[0] == 'v' &&
+	!g_variant_is_of_type(v, G_VARIANT_TYPE_VARIANT))
+      return g_variant_new_variant(v);
+    if (type && !g_variant_is_of_type(v, G_VARIANT_TYPE(type)))
+      y_errorq("GVariant is not of type %s", type);
+    return v;
+  }
+  if (yarg_nil(iarg)) y_error("cannot convert nil to GVariant");
+  if (type && !g_variant_type_string_is_valid(type))
+    y_errorq("invalid GVariant type: %s", type);
+  if (type && type[0] == 'v')
+    return g_variant_new_variant(gy_variant_get(iarg, NULL));
+
+  typeid = yarg_typeid(iarg);
+  rank = yarg_rank(iarg);
+
+  if (typeid == Y_STRING) {
+    if (!type || !strcmp(type, "s") || !strcmp(type, "o") ||
+	!strcmp(type, "g") || !strcmp(type, "as")) {
+      ystring_t * str = ygeta_q(iarg, &ntot, NULL);
+      if (rank == 0 && (!type || type[0] != 'a')) {
+	if (!str[0]) y_error("cannot convert string(0) to GVariant");
+	if (type && type[0] == 'o')
+	  return g_variant_new_object_path(str[0]);
+	if (type && type[0] == 'g')
+	  return g_variant_new_signature(str[0]);
+	return g_variant_new_string(str[0]);
+      }
+      long i;
+      for (i=0; i<ntot; ++i)
+	if (!str[i]) y_error("cannot convert string(0) to GVariant");
+      return g_variant_new_strv((const gchar * const *) str, ntot);
+    }
+    // text representation, e.g. "{'a': <1>}"
+    if (rank) y_error("expecting a scalar string");
+    v = g_variant_parse(G_VARIANT_TYPE(type), ygets_q(iarg),
+			NULL, NULL, &err);
+    if (!v) y_error(err->message);
+    return v;
+  }
+
+  if (!type) {
+    if (!(buf[rank ? 1 : 0] = gy_variant_natural(typeid)))
+      y_error("cannot convert this Yorick type to GVariant");
+    if (rank) buf[0] = 'a';
+    type = buf;
+  }
+  if ((rank && type[0] != 'a') || strlen(type) != (rank ? 2 : 1) ||
+      gy_variant_typeid(type[rank ? 1 : 0]) < 0)
+    y_errorq("cannot convert numeric value to GVariant of type %s", type);
+
+  if (rank) {
+    // convert in place to the type of the elements
+    gboolean trusted = TRUE;
+    unsigned char * c;
+    long i;
+    switch (gy_variant_typeid(type[1])) {
+    case Y_CHAR:
+      c = ygeta_c(iarg, &ntot, NULL);
+      // booleans are in normal form only if 0 or 1
+      if (type[1] == 'b')
+	for (i=0; i<ntot && trusted; ++i) trusted = c[i] <= 1;
+      break;
+    case Y_SHORT: ygeta_s(iarg, &ntot, NULL); break;
+    case Y_INT:   ygeta_i(iarg, &ntot, NULL); break;
+    case Y_LONG:  ygeta_l(iarg, &ntot, NULL); break;
+    default:      ygeta_d(iarg, &ntot, NULL);
+    }
+    GBytes * bytes = gy_bytes_get(iarg);
+    v = g_variant_new_from_bytes(G_VARIANT_TYPE(type), bytes, trusted);
+    g_bytes_unref(bytes);
+    return v;
+  }
+
+  // scalars are not converted in place, which would truncate unsigned
+  // values
+  switch (type[0]) {
+  case 'b': return g_variant_new_boolean(ygets_l(iarg) != 0);
+  case 'y': return g_variant_new_byte(ygets_c(iarg));
+  case 'n': return g_variant_new_int16(ygets_s(iarg));
+  case 'q': return g_variant_new_uint16(ygets_l(iarg));
+  case 'i': return g_variant_new_int32(ygets_i(iarg));
+  case 'u': return g_variant_new_uint32(ygets_l(iarg));
+  case 'h': return g_variant_new_handle(ygets_i(iarg));
+  case 'x': return g_variant_new_int64(ygets_l(iarg));
+  case 't': return g_variant_new_uint64(ygets_l(iarg));
+  default:  return g_variant_new_double(ygets_d(iarg));
+  }
+}
+
+void
+Y_gy_variant(int argc)
+{
+  const gchar * type = NULL;
+  if (argc < 1 || argc > 2) y_error("gy_variant takes 1 or 2 arguments");
+  if (argc == 2 && !yarg_nil(0)) type = ygets_q(0);
+  gy_variant_push_object(gy_variant_get(argc-1, type));
+}
+
+void
+Y_gy_variant_value(int argc)
+{
+  if (argc != 1) y_error("gy_variant_value takes exactly one argument");
+  GVariant * v = g_variant_ref_sink(gy_variant_get(0, NULL));
+  gy_variant_push(v);
+  g_variant_unref(v);
+}